@@ -22,6 +22,9 @@ class Body {
     Eigen::Vector3d angular_velocity_;         ///< Net instantaneous lab frame angular velocity of body
     Eigen::Matrix<double, 6, 1> force_torque_; ///< Net force+torque vector [fx,fy,fz,tx,ty,tz] about centroid
     Eigen::VectorXd RHS_;                      ///< Current 'right-hand-side' for matrix formulation of solver
+    Eigen::VectorXd solution_vec_; ///< [get_solution_size()] block of the last solve (rank 0 only)
+    Eigen::Vector3d displacement_prev_ = Eigen::Vector3d::Zero(); ///< Position increment of the last step, for BDF2
+    Eigen::Vector3d rotation_prev_ = Eigen::Vector3d::Zero();     ///< Rotation vector of the last step, for BDF2
 
     Eigen::MatrixXd ex_; ///< [ 3 x num_nodes ] Singularity subtraction vector along x
     Eigen::MatrixXd ey_; ///< [ 3 x num_nodes ] Singularity subtraction vector along y
@@ -43,20 +46,48 @@ class Body {
     /// [3] vector of constant external force on body in lab frame
     Eigen::Vector3d external_force_{0.0, 0.0, 0.0};
 
-    Eigen::MatrixXd A_;                         ///< Matrix representation of body for solver
-    Eigen::PartialPivLU<Eigen::MatrixXd> A_LU_; ///< LU decomposition of A_ for preconditioner
+    Eigen::MatrixXd A_;                         ///< Matrix representation of body for solver, at the current pose
+    Eigen::PartialPivLU<Eigen::MatrixXd> A_LU_; ///< LU decomposition of A_ at last refresh, for preconditioner
+
+    /// Body frame operator state from the last full cache refresh. @see update_cache_variables
+    struct {
+        Eigen::Quaterniond orientation = {1.0, 0.0, 0.0, 0.0}; ///< orientation_ at refresh
+        Eigen::MatrixXd ex;                                    ///< ex_ at refresh
+        Eigen::MatrixXd ey;                                    ///< ey_ at refresh
+        Eigen::MatrixXd ez;                                    ///< ez_ at refresh
+        Eigen::Quaterniond operator_orientation = {1.0, 0.0, 0.0, 0.0}; ///< orientation_ A_ was last rotated to
+        int age = -1; ///< update_cache_variables calls since refresh, -1 if never refreshed
+    } refresh_;
+
+    /// Pose the cache variables were last updated for, so a retried step at the same pose skips the update
+    struct {
+        Eigen::Vector3d position;
+        Eigen::Quaterniond orientation;
+        bool valid = false;
+    } cached_pose_;
 
     Body(const toml::value &body_table, const Params &params);
     Body() = default; ///< default constructor...
+    virtual ~Body() = default;
 
     /// Return reference to body COM position
     const Eigen::Vector3d &get_position() const { return position_; };
-    void update_RHS(MatrixRef &v_on_body);
-    void update_cache_variables(double eta);
+    /// Size of this body's block of the solution vector: node densities, then velocity and angular velocity
+    virtual int get_solution_size() const { return 3 * n_nodes_ + 6; }
+    /// True if the body is represented by multipoles at its center rather than by surface densities
+    virtual bool is_multipole() const { return false; }
+    virtual void update_RHS(MatrixRef &v_on_body);
+    virtual void update_cache_variables(double eta, int refresh_interval = 1);
+    void take_cache_variables(Body &rejected);
+    Eigen::Matrix3d get_rotation_since_refresh() const;
+    virtual Eigen::VectorXd matvec(MatrixRef &v_body, MatrixRef &density, VectorRef &velocity) const;
+    virtual Eigen::VectorXd apply_preconditioner(VectorRef &x) const;
+    virtual Eigen::MatrixXd get_operator() const;
+    static Eigen::MatrixXd rotate_operator(const Eigen::MatrixXd &A, const Eigen::Matrix3d &R);
     void update_K_matrix();
     void update_preconditioner(double eta);
     void update_singularity_subtraction_vecs(double eta);
-    void load_precompute_data(const std::string &input_file);
+    void load_precompute_data(const std::string &input_file, bool root_only = false);
     void move(const Eigen::Vector3d &new_pos, const Eigen::Quaterniond &new_orientation);
 
     /// @brief Make a copy of this instance
@@ -85,6 +116,9 @@ class Body {
     /// For structures with fixed size Eigen::Vector types, this ensures alignment if the
     /// structure is allocated via `new`
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  protected:
+    Body(const toml::value &body_table);
 };
 
 /// @brief Container for multiple generic Body objects
@@ -92,6 +126,7 @@ class BodyContainer {
   private:
     int world_rank_ = 0; ///< MPI world rank
     int world_size_;     ///< MPI world size
+    bool root_only_operators_ = false; ///< Body operators are only built on rank 0. @see Params::node_shared_operators
 
   public:
     /// Vector of body pointers
@@ -114,6 +149,7 @@ class BodyContainer {
         }
         world_rank_ = orig.world_rank_;
         world_size_ = orig.world_size_;
+        root_only_operators_ = orig.root_only_operators_;
         stresslet_kernel_ = orig.stresslet_kernel_;
         oseen_kernel_ = orig.oseen_kernel_;
     };
@@ -126,6 +162,7 @@ class BodyContainer {
         }
         world_rank_ = orig.world_rank_;
         world_size_ = orig.world_size_;
+        root_only_operators_ = orig.root_only_operators_;
         stresslet_kernel_ = orig.stresslet_kernel_;
         oseen_kernel_ = orig.oseen_kernel_;
         return *this;
@@ -149,7 +186,13 @@ class BodyContainer {
     /// Since there aren't many bodies, and there is no easy way to synchronize them across processes, the rank 0
     /// process handles all components of the solution.
     int get_local_solution_size() const {
-        return (world_rank_ == 0) ? 3 * get_local_node_count() + 6 * bodies.size() : 0;
+        if (world_rank_ != 0)
+            return 0;
+
+        int tot = 0;
+        for (const auto &body : bodies)
+            tot += body->get_solution_size();
+        return tot;
     }
 
     void update_RHS(MatrixRef &v_on_body);
@@ -173,19 +216,25 @@ class BodyContainer {
         return centers;
     };
 
-    std::pair<Eigen::MatrixXd, Eigen::MatrixXd> unpack_solution_vector(VectorRef &x) const;
+    std::tuple<Eigen::MatrixXd, Eigen::MatrixXd, Eigen::MatrixXd> unpack_solution_vector(VectorRef &x) const;
 
     Eigen::MatrixXd get_local_center_positions() const { return get_center_positions(false); };
     Eigen::MatrixXd get_global_center_positions() const { return get_center_positions(true); };
     Eigen::VectorXd matvec(MatrixRef &v_bodies, MatrixRef &body_densities, MatrixRef &body_velocities) const;
     Eigen::VectorXd apply_preconditioner(VectorRef &X) const;
 
-    Eigen::MatrixXd flow(MatrixRef &r_trg, MatrixRef &densities, MatrixRef &force_torque_bodies, double eta) const;
+    Eigen::MatrixXd flow(MatrixRef &r_trg, MatrixRef &densities, MatrixRef &stresslets, MatrixRef &force_torque_bodies,
+                         double eta) const;
 
     /// @brief Update cache variables for each Body. @see Body::update_cache_variables
-    void update_cache_variables(double eta) {
+    ///
+    /// Body operators are only used by BodyContainer::matvec and BodyContainer::apply_preconditioner, which only do
+    /// work on rank 0, so with Params::node_shared_operators other ranks skip the update.
+    void update_cache_variables(double eta, int refresh_interval = 1) {
+        if (root_only_operators_ && world_rank_ != 0)
+            return;
         for (auto &body : bodies)
-            body->update_cache_variables(eta);
+            body->update_cache_variables(eta, refresh_interval);
     }
 
     /// @brief Get copy of a given nucleation site
@@ -244,6 +293,44 @@ class SphericalBody : public Body {
     bool check_collision(const Periphery &periphery, double threshold) const override;
     bool check_collision(const Body &body, double threshold) const override;
     bool check_collision(const SphericalBody &body, double threshold) const override;
+
+  protected:
+    SphericalBody(const toml::value &body_table) : Body(body_table) {
+        radius_ = toml::find_or<double>(body_table, "radius", 0.0);
+    };
+};
+
+/// @brief Reduced-order sphere, represented by a Stokeslet, rotlet and stresslet at its center
+///
+/// Selected with `representation = "multipole"` in the body table. No precompute file or surface solve is needed.
+/// The solution block is [stresslet (xx, yy, zz, xy, xz, yz), velocity, angular velocity]. The velocity \f$u\f$ from
+/// every source, this body's own included, is sampled on the body surface, where its moments give Faxen's laws:
+/// \f[ U = \langle u \rangle, \quad \Omega = \frac{3}{2a} \langle n \times u \rangle, \quad
+///     S = 5 \eta \oint (n u)^{\textrm{dev}} dS \f]
+/// with \f$(\cdot)^{\textrm{dev}}\f$ the symmetric traceless part. The body's own Stokeslet and rotlet supply the
+/// single sphere mobilities \f$F / 6 \pi \eta a\f$ and \f$T / 8 \pi \eta a^3\f$ through these moments, so the
+/// block is the identity up to coupling. Finite size corrections of the emitted flow beyond the stresslet are
+/// dropped, an \f$O(a^2 / d^2)\f$ relative error at separation d.
+class MultipoleSphericalBody : public SphericalBody {
+  public:
+    MultipoleSphericalBody(const toml::value &body_table, const Params &params);
+
+    std::unique_ptr<Body> clone() const override { return std::make_unique<MultipoleSphericalBody>(*this); };
+
+    int get_solution_size() const override { return 12; }
+    bool is_multipole() const override { return true; }
+    void update_RHS(MatrixRef &v_on_body) override;
+    /// Nothing to cache, the nodes only sample the flow
+    void update_cache_variables(double eta, int refresh_interval = 1) override {}
+    Eigen::VectorXd matvec(MatrixRef &v_body, MatrixRef &density, VectorRef &velocity) const override;
+    Eigen::VectorXd apply_preconditioner(VectorRef &x) const override { return x; }
+    Eigen::MatrixXd get_operator() const override { return Eigen::MatrixXd::Identity(12, 12); }
+
+    Eigen::Matrix<double, 12, 1> get_moments(MatrixRef &v_body) const;
+    static Eigen::Matrix3d unpack_stresslet(VectorRef &s);
+
+  private:
+    double eta_; ///< Fluid viscosity
 };
 
 #endif
@@ -0,0 +1,56 @@
+#ifndef COARSE_CORRECTION_HPP
+#define COARSE_CORRECTION_HPP
+
+#include <skelly_sim.hpp>
+
+#include <Eigen/LU>
+#include <vector>
+
+/// @brief Optional second (coarse) level for the block-local System preconditioner
+///
+/// The coarse space is spanned by rigid translations of each fiber, rigid motions of each body
+/// and rigid translations of the shell density. A rigid fiber translation generates no fiber
+/// force, so its columns of the Galerkin operator are local to the fiber and can be built from
+/// Fiber::A_ without any FMM calls. The body and shell ("global") columns are obtained from the
+/// true System::apply_matvec. Ordering the global modes first, the Galerkin operator \f$Z^T A Z\f$
+/// is block lower triangular, so the coarse solve is a small dense solve for the global modes
+/// followed by an independent 3x3 solve per fiber.
+///
+/// Setup costs 6 * n_bodies + 3 full matvecs (each with its FMM calls) per step, one per global mode.
+class CoarseCorrection {
+  public:
+    enum Mode { None, Additive, Multiplicative };
+    static const std::string mode_name[];
+
+    /// Coarse vector, with the fiber rigid modes local to the rank and the global modes replicated
+    typedef struct {
+        Eigen::VectorXd fibers; ///< [3 * n_fibers_local] fiber rigid translation amplitudes
+        Eigen::VectorXd global; ///< [6 * n_bodies + 3] body rigid motion and shell translation amplitudes
+    } coarse_vec_t;
+
+    CoarseCorrection() = default;
+    CoarseCorrection(const std::string &mode);
+
+    Mode get_mode() const { return mode_; };
+    void update();
+    coarse_vec_t solve(VectorRef &r) const;
+    Eigen::VectorXd prolong(const coarse_vec_t &c) const;
+    Eigen::VectorXd apply_galerkin(const coarse_vec_t &c) const;
+
+  private:
+    Mode mode_ = None;
+    int n_global_ = 0;                       ///< Number of body + shell coarse modes
+    Eigen::MatrixXd Z_global_;               ///< [local_solution_size x n_global_] global coarse basis
+    Eigen::MatrixXd AZ_global_;              ///< [local_solution_size x n_global_] operator applied to global basis
+    Eigen::PartialPivLU<Eigen::MatrixXd> G_LU_; ///< LU of the global-global block of the Galerkin operator
+
+    std::vector<int> fib_offsets_;                  ///< offset of each local fiber in the solution vector
+    std::vector<int> fib_n_nodes_;                  ///< number of nodes of each local fiber
+    std::vector<Eigen::MatrixXd> AZ_fibers_;        ///< [4 * n_nodes x 3] operator applied to fiber rigid modes
+    std::vector<Eigen::MatrixXd> C_fibers_;         ///< [3 x n_global_] fiber rows of Galerkin global columns
+    std::vector<Eigen::FullPivLU<Eigen::MatrixXd>> D_LU_; ///< LU of fiber-fiber 3x3 Galerkin blocks
+
+    Eigen::Vector3d restrict_fiber(VectorRef &x, int i_fib) const;
+};
+
+#endif
@@ -6,11 +6,14 @@
 #include <Eigen/LU>
 #include <list>
 #include <unordered_map>
+#include <vector>
 
 #include <kernels.hpp>
 #include <params.hpp>
+#include <utils.hpp>
 
 class Periphery;
+class ScreenedStokeslet;
 
 /// @brief Class to represent a single flexible filament
 ///
@@ -31,7 +34,8 @@ class Fiber {
     /// \f[{\bf f} = f_s * {\bf x}_s\f]
     double force_scale_ = 0.0;
     // FIXME: Magic numbers in linear operator calculation
-    double beta_tstep_ = 1.0; ///< penalty parameter to ensure inextensibility
+    /// Leading coefficient of the time derivative, 1 for backward Euler. @see Fiber::update_time_history
+    double beta_tstep_ = 1.0;
     double epsilon_ = 1E-3;   ///< slenderness parameter
 
     /// (body, site) pair for minus end binding. -1 implies unbound
@@ -58,34 +62,63 @@ class Fiber {
     Eigen::MatrixXd xss_;   ///< [ 3 x n_nodes_ ] matrix representing second derivative of fiber nodes
     Eigen::MatrixXd xsss_;  ///< [ 3 x n_nodes_ ] matrix representing third derivative of fiber nodes
     Eigen::MatrixXd xssss_; ///< [ 3 x n_nodes_ ] matrix representing fourth derivative of fiber nodes
+    Eigen::VectorXd tension_; ///< [ n_nodes_ ] tension from the last solve (empty before the first)
+    Eigen::MatrixXd x_prev_;  ///< [ 3 x n_nodes_ ] positions at the start of the last step (empty if not kept)
+    /// [ 3 x n_nodes_ ] history term of the BDF2 time derivative (empty for a first order step)
+    /// @see Fiber::update_time_history
+    Eigen::MatrixXd x_hist_;
 
     /// [ 3*n_nodes_ x 3*n_nodes_] Oseen tensor for fiber @see Fiber::update_stokeslet
     Eigen::MatrixXd stokeslet_;
 
     Eigen::MatrixXd A_;                         ///< Fiber's linear operator for matrix solver
     Eigen::FullPivLU<Eigen::MatrixXd> A_LU_; ///< Fiber preconditioner, LU decomposition of Fiber::A_
+    Eigen::FullPivLU<Eigen::MatrixXf> A_LU_f_; ///< Single precision A_LU_, used instead for mixed precision solves
+
+    /// State of the fiber when Fiber::A_LU_ was last computed, to decide when a lagged factorization is stale
+    struct {
+        Eigen::MatrixXd xs;                ///< Fiber::xs_ at factorization (empty if never factorized)
+        Eigen::MatrixXd xss;               ///< Fiber::xss_ at factorization
+        double length = 0.0;               ///< Fiber::length_ at factorization
+        double dt = 0.0;                   ///< timestep over Fiber::beta_tstep_ at factorization
+        std::pair<BC, BC> bc_minus;        ///< Fiber::bc_minus_ at factorization
+        std::pair<BC, BC> bc_plus;         ///< Fiber::bc_plus_ at factorization
+        bool single_precision = false;     ///< Factorization is in Fiber::A_LU_f_ rather than Fiber::A_LU_
+    } factorized_;
+    /// Geometry the position-only caches (derivatives, stokeslet_) were built for. @see Fiber::geometry_is_current
+    struct {
+        Eigen::MatrixXd x;         ///< Fiber::x_ when built (empty if never built)
+        double length_prev = 0.0;  ///< Fiber::length_prev_ when built
+        int8_t near_periphery = -1; ///< Fiber::near_periphery for this geometry, -1 if not yet checked
+    } geometry_;
     /// Fiber force operator, @see Fiber::update_force_operator, FiberContainer::apply_fiber_force
     Eigen::MatrixXd force_operator_;
     Eigen::VectorXd RHS_; ///< Current 'right-hand-side' for matrix formulation of solver
 
-    /// Structure that caches arrays useful for calculating various fiber values
+    /// Structure that caches arrays useful for calculating various fiber values. The arrays are read-only views into
+    /// Fiber::matrices_buffer_
     typedef struct {
-        Eigen::ArrayXd alpha;
-        Eigen::ArrayXd alpha_roots;
-        Eigen::ArrayXd alpha_tension;
-        Eigen::ArrayXd weights_0;
-        Eigen::MatrixXd D_1_0;
-        Eigen::MatrixXd D_2_0;
-        Eigen::MatrixXd D_3_0;
-        Eigen::MatrixXd D_4_0;
-        Eigen::MatrixXd P_X;
-        Eigen::MatrixXd P_T;
-        Eigen::MatrixXd P_downsample_bc;
+        Eigen::Map<const Eigen::ArrayXd> alpha{nullptr, 0};
+        Eigen::Map<const Eigen::ArrayXd> alpha_roots{nullptr, 0};
+        Eigen::Map<const Eigen::ArrayXd> alpha_tension{nullptr, 0};
+        Eigen::Map<const Eigen::ArrayXd> weights_0{nullptr, 0};
+        Eigen::Map<const Eigen::MatrixXd> D_1_0{nullptr, 0, 0};
+        Eigen::Map<const Eigen::MatrixXd> D_2_0{nullptr, 0, 0};
+        Eigen::Map<const Eigen::MatrixXd> D_3_0{nullptr, 0, 0};
+        Eigen::Map<const Eigen::MatrixXd> D_4_0{nullptr, 0, 0};
+        Eigen::Map<const Eigen::MatrixXd> P_X{nullptr, 0, 0};
+        Eigen::Map<const Eigen::MatrixXd> P_T{nullptr, 0, 0};
+        Eigen::Map<const Eigen::MatrixXd> P_downsample_bc{nullptr, 0, 0};
     } fib_mat_t;
 
-    /// Map of cached matrices for different values of n_nodes_. Calculated automagically at program start. @see
-    /// compute_matrices
-    const static std::unordered_map<int, fib_mat_t> matrices_;
+    /// Supported values of n_nodes_, in ascending order. @see compute_matrices
+    const static std::vector<int> supported_n_nodes_;
+
+    /// Map of cached matrices for different values of n_nodes_. Calculated automagically at program start, and only
+    /// replaced by share_matrices. @see compute_matrices
+    static std::unordered_map<int, fib_mat_t> matrices_;
+    static utils::SharedBuffer matrices_buffer_; ///< Storage of every array in Fiber::matrices_
+    static void share_matrices();
 
     Fiber(toml::value &fiber_table, double eta);
     Fiber() = default;
@@ -119,17 +152,25 @@ class Fiber {
         c_1_ = 2.0 / (8.0 * M_PI * eta);
     };
 
-    void update_preconditioner();
+    void update_preconditioner(double dt, bool single_precision = false);
+    bool preconditioner_is_current(double dt, double geometry_tol, double length_tol, double dt_tol) const;
+    bool geometry_is_current() const;
+    void take_geometry_caches(Fiber &rejected);
     void update_force_operator();
+    void update_time_history(double omega, bool keep_history);
     void update_RHS(double dt, MatrixRef &flow, MatrixRef &f_external);
     void update_linear_operator(double dt, double eta);
     void apply_bc_rectangular(double dt, MatrixRef &v_on_fiber, MatrixRef &f_on_fiber);
     void translate(const Eigen::Vector3d &r) { x_.colwise() += r; };
     void update_derivatives();
     void update_stokeslet(double);
+    void resample(int n_nodes_new);
+    double max_curvature() const;
+    /// @brief Positions the time derivative is taken from: Fiber::x_hist_ if set for this step, else Fiber::x_
+    const Eigen::MatrixXd &get_history_positions() const { return x_hist_.cols() == n_nodes_ ? x_hist_ : x_; }
     bool attached_to_body() { return binding_site_.first >= 0; };
-    MSGPACK_DEFINE_MAP(n_nodes_, length_, bending_rigidity_, penalty_param_, force_scale_, beta_tstep_, epsilon_,
-                       binding_site_, x_);
+    MSGPACK_DEFINE_MAP(n_nodes_, length_, bending_rigidity_, penalty_param_, force_scale_, epsilon_, binding_site_,
+                       x_);
 };
 
 /// Class to hold the fiber objects.
@@ -145,8 +186,41 @@ class Fiber {
 class FiberContainer {
   public:
     std::list<Fiber> fibers; ///< Array of fibers local to this MPI rank
+
+    /// Thresholds below which a fiber reuses its previous LU factorization as preconditioner. Zero disables reuse.
+    /// @see Fiber::preconditioner_is_current
+    struct {
+        double geometry_tol = 0.0; ///< max change in tangent xs and in length * xss
+        double length_tol = 0.0;   ///< max relative change in length
+        double dt_tol = 0.0;       ///< max relative change in timestep
+        /// Factorize in single precision, for the inner solves of Solver::solve_mixed_precision only
+        bool single_precision = false;
+        bool factorize = true;         ///< False when TrilinosPreconditioner replaces the fiber LUs
+    } refactor_policy_;
+
+    /// Process-wide fiber preconditioner factorization statistics. Survives System::restore on rejected steps.
+    struct preconditioner_stats_t {
+        long n_factorized = 0;      ///< Number of fiber LU factorizations computed
+        long n_reused = 0;          ///< Number of times a lagged factorization was reused
+        double factor_time = 0.0;   ///< Total wall time spent in fiber LU factorizations
+    };
+    static preconditioner_stats_t preconditioner_stats_;
+
+    /// Criteria to adapt each fiber's n_nodes_ to its length and curvature. @see FiberContainer::update_resolution
+    struct {
+        bool adaptive = false;       ///< Resample fibers when steps are accepted
+        int min_nodes = 8;           ///< Smallest allowed n_nodes_
+        int max_nodes = 128;         ///< Largest allowed n_nodes_
+        double max_spacing = 0.1;    ///< Largest allowed arc length between nodes
+        double max_angle = 0.2;      ///< Largest allowed tangent rotation (radians) between nodes
+        double coarsen_margin = 0.5; ///< Coarsen only if the criteria hold with tolerances scaled by this factor
+    } resolution_policy_;
     /// pointer to FMM object (pointer to avoid constructing stokeslet_kernel_ with default FiberContainer)
     std::shared_ptr<kernels::FMM<stkfmm::Stk3DFMM>> stokeslet_kernel_;
+    /// Lower multipole order stokeslet_kernel_ for the inner operator of Solver::solve_mixed_precision (unset otherwise)
+    std::shared_ptr<kernels::FMM<stkfmm::Stk3DFMM>> stokeslet_kernel_low_;
+    /// Cutoff fiber flow used in place of stokeslet_kernel_, if Params::fiber_screening sets a cutoff
+    std::shared_ptr<ScreenedStokeslet> screened_kernel_;
 
     /// Empty container constructor to avoid initialization list complications. No way to
     /// initialize after using this constructor, so overwrite objects with full constructor.
@@ -156,9 +230,13 @@ class FiberContainer {
     void update_derivatives();
     void update_stokeslets(double eta);
     void update_linear_operators(double dt, double eta);
-    void update_cache_variables(double dt, double eta);
+    int update_cache_variables(double dt, double eta);
+    void take_geometry_caches(FiberContainer &rejected);
+    void update_time_history(double omega, bool keep_history);
     void update_RHS(double dt, MatrixRef &v_on_fibers, MatrixRef &f_on_fibers);
-    void apply_bc_rectangular(double dt, MatrixRef &v_on_fibers, MatrixRef &f_on_fibers);
+    void apply_bc_rectangular(double dt, MatrixRef &v_on_fibers, MatrixRef &f_on_fibers, bool factorize = true);
+    int select_n_nodes(double length, double curvature, double scale = 1.0) const;
+    int update_resolution();
 
     /// @brief get total number of nodes across fibers in the container
     /// Usually you need this to form arrays used as input later
@@ -179,25 +257,83 @@ class FiberContainer {
     /// @brief Get number of local fibers
     int get_local_count() const { return fibers.size(); };
 
-    /// @brief Get number of local fibers
+    /// @brief Get number of fibers across all ranks
     int get_global_count() const;
+    /// @brief Cache the result of get_global_count while the fibers are unchanged on all ranks, -1 to clear
+    void set_global_count(int n_fibers) { global_count_ = n_fibers; }
 
     Eigen::MatrixXd generate_constant_force() const;
     Eigen::MatrixXd get_local_node_positions() const;
     Eigen::VectorXd get_RHS() const;
-    Eigen::MatrixXd flow(MatrixRef &forces, MatrixRef &r_trg_external, double eta) const;
+    Eigen::MatrixXd flow(MatrixRef &forces, MatrixRef &r_trg_external, double eta, bool full_fmm = false,
+                         bool single_precision = false) const;
     Eigen::VectorXd matvec(VectorRef &x_all, MatrixRef &v_fib, MatrixRef &v_fib_boundary) const;
     Eigen::MatrixXd apply_fiber_force(VectorRef &x_all) const;
-    Eigen::VectorXd apply_preconditioner(VectorRef &x_all) const;
+    Eigen::VectorXd apply_preconditioner(VectorRef &x_all, bool single_precision = false) const;
 
     void update_boundary_conditions(Periphery &shell, bool periphery_binding_flag);
 
   private:
     int world_size_ = -1;
     int world_rank_;
+    int global_count_ = -1; ///< Cached global fiber count, -1 to reduce on every get_global_count call
 
   public:
-    MSGPACK_DEFINE(fibers);
+    /// When serializing: include the per-fiber constant parameters (set by System::write). When deserializing: whether
+    /// the frame included them.
+    bool with_constant_params_ = true;
+
+    std::vector<double> get_constant_params() const;
+    void copy_constant_params(const FiberContainer &src);
+
+    /// @brief Serialize in columns: n_nodes, length and binding_site arrays, and every fiber's nodes in one binary block
+    ///
+    /// Floating point columns are raw (native, little-endian) doubles in msgpack bin objects, so they can be written
+    /// and read with memcpy. The constant parameters bending_rigidity, penalty_param, force_scale and epsilon are
+    /// only written when with_constant_params_ is set. Fiber::beta_tstep_ is per-step state, set by
+    /// Fiber::update_time_history, and is not written.
+    template <typename Packer>
+    void msgpack_pack(Packer &pk) const {
+        const uint32_t n_fibers = fibers.size();
+        auto pack_column = [&pk, n_fibers, this](const char *key, double Fiber::*member) {
+            pk.pack(key);
+            pk.pack_bin(n_fibers * sizeof(double));
+            for (const auto &fib : fibers)
+                pk.pack_bin_body(reinterpret_cast<const char *>(&(fib.*member)), sizeof(double));
+        };
+
+        pk.pack_map(with_constant_params_ ? 8 : 4);
+        pk.pack("n_nodes");
+        pk.pack_array(n_fibers);
+        for (const auto &fib : fibers)
+            pk.pack(fib.n_nodes_);
+
+        pack_column("length", &Fiber::length_);
+
+        pk.pack("binding_site");
+        pk.pack_array(2 * n_fibers);
+        for (const auto &fib : fibers) {
+            pk.pack(fib.binding_site_.first);
+            pk.pack(fib.binding_site_.second);
+        }
+
+        pk.pack("x");
+        pk.pack_bin(3 * get_local_node_count() * sizeof(double));
+        for (const auto &fib : fibers)
+            pk.pack_bin_body(reinterpret_cast<const char *>(fib.x_.data()), fib.x_.size() * sizeof(double));
+
+        if (with_constant_params_) {
+            pack_column("bending_rigidity", &Fiber::bending_rigidity_);
+            pack_column("penalty_param", &Fiber::penalty_param_);
+            pack_column("force_scale", &Fiber::force_scale_);
+            pack_column("epsilon", &Fiber::epsilon_);
+        }
+    }
+
+    void msgpack_unpack(msgpack::object o);
+
+    template <typename MSGPACK_OBJECT>
+    void msgpack_object(MSGPACK_OBJECT *o, msgpack::zone *z) const {}
 };
 
 #endif
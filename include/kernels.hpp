@@ -5,6 +5,10 @@
 
 #include <Eigen/Dense>
 #include <STKFMM/STKFMM.hpp>
+#include <omp.h>
+#include <spdlog/spdlog.h>
+#include <trace.hpp>
+#include <utils.hpp>
 
 /// Namespace for miscellaneous "kernel" functions and related convenience FMM class
 namespace kernels {
@@ -44,6 +48,14 @@ class FMM {
     /// @brief Set flag to force next call to set up tree, regardless of cache variables
     void force_setup_tree() { force_setup_tree_ = true; };
 
+    /// @brief Hand sources and targets to STKFMM sorted along a Morton curve, rather than in container order
+    ///
+    /// Inputs and outputs of operator() keep the caller's order; the permutations are applied internally.
+    void set_sort_points(bool sort_points) {
+        sort_points_ = sort_points;
+        force_setup_tree_ = true;
+    };
+
     /// @brief Evaluate the FMM kernel given the given sources/targets
     ///
     /// Repeated calls to the FMM object with the same source/target positions will maintain
@@ -56,28 +68,35 @@ class FMM {
     /// @param[in] f_sl [ k_dim_dl x n_src ] matrix of 'double-layer' source strengths
     /// @returns [ k_dim_trg x n_trg ] matrix of kernel evaluated at target positions given the sources
     Eigen::MatrixXd operator()(MatrixRef &r_sl, MatrixRef &r_dl, MatrixRef &r_trg, MatrixRef &f_sl, MatrixRef &f_dl) {
+        TRACE_SCOPE("FMM", "fmm");
         // Check if LOCAL source/target points have changed, and then broadcast that for a GLOBAL update
-        char setup_flag_local =
+        const bool setup_flag_local =
             (force_setup_tree_ || r_sl_old_.size() != r_sl.size() || r_dl_old_.size() != r_dl.size() ||
              r_trg_old_.size() != r_trg.size() || r_sl_old_ != r_sl || r_dl_old_ != r_dl || r_trg_old_ != r_trg);
-        char setup_flag;
-        MPI_Allreduce(&setup_flag_local, &setup_flag, 1, MPI_CHAR, MPI_LOR, MPI_COMM_WORLD);
-
-        if (setup_flag) {
-            double sl_min = r_sl.size() ? r_sl.minCoeff() : std::numeric_limits<double>::max();
-            double dl_min = r_dl.size() ? r_dl.minCoeff() : std::numeric_limits<double>::max();
-            double trg_min = r_trg.size() ? r_trg.minCoeff() : std::numeric_limits<double>::max();
-            double sl_max = r_sl.size() ? r_sl.maxCoeff() : std::numeric_limits<double>::min();
-            double dl_max = r_dl.size() ? r_dl.maxCoeff() : std::numeric_limits<double>::min();
-            double trg_max = r_trg.size() ? r_trg.maxCoeff() : std::numeric_limits<double>::min();
 
-            // Find most extreme points to define our box, which is required to be a cube
-            double local_min = std::min(std::min(sl_min, dl_min), trg_min);
-            double local_max = std::max(std::max(sl_max, dl_max), trg_max);
+        // The bounding box is only needed for a new tree, but is reduced along with the flag to avoid a second
+        // round of collectives
+        double sl_min = r_sl.size() ? r_sl.minCoeff() : std::numeric_limits<double>::max();
+        double dl_min = r_dl.size() ? r_dl.minCoeff() : std::numeric_limits<double>::max();
+        double trg_min = r_trg.size() ? r_trg.minCoeff() : std::numeric_limits<double>::max();
+        double sl_max = r_sl.size() ? r_sl.maxCoeff() : std::numeric_limits<double>::min();
+        double dl_max = r_dl.size() ? r_dl.maxCoeff() : std::numeric_limits<double>::min();
+        double trg_max = r_trg.size() ? r_trg.maxCoeff() : std::numeric_limits<double>::min();
+
+        // Find most extreme points to define our box, which is required to be a cube
+        double local_min = std::min(std::min(sl_min, dl_min), trg_min);
+        double local_max = std::max(std::max(sl_max, dl_max), trg_max);
+
+        double reduce_max[3] = {double(setup_flag_local), -local_min, local_max};
+        {
+            TRACE_SCOPE("MPI_Allreduce FMM setup", "mpi");
+            MPI_Allreduce(MPI_IN_PLACE, reduce_max, 3, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        }
+        const bool setup_flag = reduce_max[0] > 0.0;
 
-            double global_min, global_max;
-            MPI_Allreduce(&local_min, &global_min, 1, MPI_DOUBLE, MPI_MIN, MPI_COMM_WORLD);
-            MPI_Allreduce(&local_max, &global_max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        if (setup_flag) {
+            double global_min = -reduce_max[1];
+            double global_max = reduce_max[2];
 
             // Scale box coordinates so that no source/target lies on the box boundary
             global_min *= 1.01;
@@ -85,22 +104,53 @@ class FMM {
             const double L = global_max - global_min;
 
             // Update FMM tree and cache coordinates
+            TRACE_SCOPE("FMM setupTree", "fmm");
+            double st = omp_get_wtime();
             double origin[3] = {global_min, global_min, global_min};
             fmmPtr_->setBox(origin, L);
-            fmmPtr_->setPoints(r_sl.size() / 3, r_sl.data(), r_trg.size() / 3, r_trg.data(), r_dl.size() / 3,
-                               r_dl.data());
+            if (sort_points_) {
+                sl_order_ = utils::morton_order(r_sl);
+                dl_order_ = utils::morton_order(r_dl);
+                trg_order_ = utils::morton_order(r_trg);
+                const Eigen::MatrixXd r_sl_sorted = gather_columns(r_sl, sl_order_);
+                const Eigen::MatrixXd r_dl_sorted = gather_columns(r_dl, dl_order_);
+                const Eigen::MatrixXd r_trg_sorted = gather_columns(r_trg, trg_order_);
+                fmmPtr_->setPoints(r_sl.size() / 3, r_sl_sorted.data(), r_trg.size() / 3, r_trg_sorted.data(),
+                                   r_dl.size() / 3, r_dl_sorted.data());
+            } else {
+                fmmPtr_->setPoints(r_sl.size() / 3, r_sl.data(), r_trg.size() / 3, r_trg.data(), r_dl.size() / 3,
+                                   r_dl.data());
+            }
             fmmPtr_->setupTree(k_);
+            spdlog::debug("FMM point setup took {} seconds (sorted: {})", omp_get_wtime() - st, sort_points_);
             r_sl_old_ = r_sl;
             r_dl_old_ = r_dl;
             r_trg_old_ = r_trg;
             force_setup_tree_ = false;
         }
 
+        TRACE_SCOPE("FMM evaluate", "fmm");
         int n_trg = r_trg.size() / 3;
-        return kernel_func_(n_trg, f_sl, f_dl, fmmPtr_.get());
+        if (!sort_points_)
+            return kernel_func_(n_trg, f_sl, f_dl, fmmPtr_.get());
+
+        const Eigen::MatrixXd res_sorted = kernel_func_(n_trg, gather_columns(f_sl, sl_order_),
+                                                        gather_columns(f_dl, dl_order_), fmmPtr_.get());
+        Eigen::MatrixXd res(res_sorted.rows(), res_sorted.cols());
+        for (int i = 0; i < n_trg; ++i)
+            res.col(trg_order_[i]) = res_sorted.col(i);
+        return res;
     }
 
   private:
+    /// @brief Copy of x with columns in the given order, y.col(i) = x.col(order[i])
+    static Eigen::MatrixXd gather_columns(MatrixRef &x, const std::vector<int> &order) {
+        Eigen::MatrixXd y(x.rows(), order.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            y.col(i) = x.col(order[i]);
+        return y;
+    }
+
     std::unique_ptr<stkfmm::STKFMM> fmmPtr_; ///< Pointer to underlying STKFMM object
     bool force_setup_tree_ = true; ///< When set, forces tree to rebuild on next call, then is cleared. Useful for
                                    ///< testing/benchmarking
@@ -108,6 +158,10 @@ class FMM {
     Eigen::MatrixXd r_dl_old_;     ///< cache 'double-layer' source positions to check for FMM tree invalidation
     Eigen::MatrixXd r_trg_old_;    ///< cache target positions to check for FMM tree invalidation
     stkfmm::KERNEL k_;             ///< Kernel enum from STKFMM that this interaction calls
+    bool sort_points_ = false;     ///< Pass points to STKFMM in Morton order. @see set_sort_points
+    std::vector<int> sl_order_;    ///< Morton order of 'single-layer' sources, if sort_points_
+    std::vector<int> dl_order_;    ///< Morton order of 'double-layer' sources, if sort_points_
+    std::vector<int> trg_order_;   ///< Morton order of targets, if sort_points_
     fmm_kernel_func_t
         kernel_func_; ///< Kernel function pointer from our own kernels namespace for the kernel this object will call
 };
@@ -17,6 +17,22 @@ class Params {
     double dt_max;
     double dt_write;
     bool periphery_binding_flag;
+    /// Body operator amortisation: steps between full rebuilds (kernel evaluation and LU) of body operators. This is
+    /// not multirate stepping. Bodies still move and enter the coupled solve every step with exact operators, and body
+    /// velocities are never interpolated. The shell is not covered: its operators are built once, and its FMM flows,
+    /// like the body collision checks and moves, are still evaluated every step. @see Body::update_cache_variables
+    int body_refresh_interval;
+    /// Keep one copy per node of read-only operators (shell operators, Fiber::matrices_) and build body operators
+    /// only on rank 0. @see utils::SharedBuffer
+    bool node_shared_operators;
+    std::string shell_node_ordering; ///< Shell node numbering for partitioning: "index" or "morton"
+    std::string fiber_ordering;      ///< Fiber distribution/container order: "input" or "morton"
+    /// Time integrator: "bdf1" (backward Euler) or "bdf2" (variable-step BDF2). @see Fiber::update_time_history
+    /// bdf2 is semi-implicit: the operator, boundary conditions and explicit flows are evaluated at fiber and body
+    /// geometry extrapolated from the last two steps, which keeps it second order. It starts with a bdf1 step, and
+    /// falls back to one after step ratios above 1 + sqrt(2) and for fibers without history (new, resampled or
+    /// growing). The extrapolation narrows the stable step size compared to bdf1
+    std::string time_scheme;
     struct {
         int n_nodes = 0;
         double v_growth;
@@ -39,8 +55,112 @@ class Params {
         int fiber_stokeslet_max_points = 2000;
         int periphery_stresslet_multipole_order = 8;
         int periphery_stresslet_max_points = 2000;
+        bool sort_points = false; ///< Pass points to STKFMM in Morton order. @see kernels::FMM::set_sort_points
     } stkfmm;
 
+    struct {
+        /// Second level of the preconditioner: "none", "additive" or "multiplicative" @see CoarseCorrection
+        std::string coarse_correction = "none";
+        /// Reuse a fiber's LU while its tangent/curvature change stays below this. @see Fiber::preconditioner_is_current
+        double fiber_refactor_geometry_tol = 0.0;
+        double fiber_refactor_length_tol = 0.0; ///< Reuse a fiber's LU while its relative length change stays below this
+        double fiber_refactor_dt_tol = 0.0;     ///< Reuse a fiber's LU while the relative dt change stays below this
+        /// Ifpack2 preconditioner replacing the fiber and body LUs, e.g. "BLOCK RELAXATION", "RILUK", "SCHWARZ".
+        /// Only pivoting ones suit fibers. Empty keeps the LUs. @see TrilinosPreconditioner
+        std::string ifpack2_type;
+        toml::value ifpack2_parameters; ///< Ifpack2 parameter list, e.g. {"fact: iluk level-of-fill" = 1}
+    } preconditioner;
+
+    /// Krylov method of the step solve: "GMRES", "PSEUDOBLOCK GMRES", "BLOCK GMRES" or one of the Tpetra variants
+    /// "TPETRA GMRES SINGLE REDUCE", "TPETRA GMRES PIPELINE", "TPETRA GMRES S-STEP". Checked when parsed. @see
+    /// Solver::solve
+    ///
+    /// Global reductions per iteration, beyond those of the matvec: "PSEUDOBLOCK GMRES" with "ICGS" takes ~4,
+    /// "TPETRA GMRES SINGLE REDUCE" 1, "TPETRA GMRES PIPELINE" 1 overlapped with the matvec, and "TPETRA GMRES S-STEP"
+    /// ~2 per step_size iterations.
+    struct {
+        std::string method = "PSEUDOBLOCK GMRES";
+        /// "ICGS", "IMGS" or "DGKS" for the Belos methods, "CGS2", "CholQR" or "CholQR2" for the Tpetra variants.
+        /// Empty picks the first of these for the method
+        std::string orthogonalization;
+        int restart = 300;   ///< Krylov vectors kept between restarts ("Num Blocks")
+        int step_size = 5;   ///< Matvecs per block orthogonalization of "TPETRA GMRES S-STEP"
+    } krylov;
+
+    /// Dense LU of the assembled operator in place of GMRES for small systems. @see Solver::solve_direct
+    struct {
+        /// Largest global solution size solved directly. Assembly costs one matvec per unknown, so keep this near the
+        /// GMRES iteration count times a small factor. 0 disables. Direct steps skip the fiber and Ifpack2
+        /// preconditioner setup. Ignored with imex
+        int max_size = 0;
+    } direct_solve;
+
+    /// Double precision iterative refinement around single precision GMRES, preconditioners and inner operator. The
+    /// inner operator evaluates the fiber and shell FMMs at a lower multipole order and the dense shell operator in
+    /// float. Residuals use the full double precision operator. @see Solver::solve_mixed_precision
+    struct {
+        bool enabled = false;
+        double inner_tol = 1E-4;        ///< Relative tolerance of each inner GMRES solve. Not below ~1E-6 in float
+        int max_refinements = 10;       ///< Outer refinement steps before the solve counts as not converged
+        int restart = 100;              ///< Krylov subspace size of the inner GMRES
+        int max_inner_iterations = 500; ///< Iteration limit of each inner GMRES solve
+        int multipole_order = 6;        ///< Multipole order of the fiber and shell FMMs of the inner operator
+    } mixed_precision;
+
+    /// Explicit hydrodynamic coupling / implicit local fiber mechanics. @see System::solve_imex
+    /// Incompatible with lagged fiber refactorization, ifpack2_type and mixed_precision, whose local solves are inexact
+    struct {
+        bool enabled = false;
+        double fallback_tol = 1E-2; ///< Relative residual above which the step is redone with the full solve
+        bool fallback = true;       ///< If false, only warn when the residual exceeds fallback_tol
+    } imex;
+
+    /// Fiber flow truncated at a cutoff, from cell list direct sums instead of the FMM. @see ScreenedStokeslet
+    struct {
+        double cutoff = 0.0; ///< Interaction range. 0 keeps the full FMM
+        double taper = 0.0;  ///< Fraction of the cutoff over which interactions fade to zero. 0 truncates sharply
+        int error_check_interval = 0; ///< Steps between comparisons against the full FMM. 0 never compares
+    } fiber_screening;
+
+    /// Adaptive fiber resolution. @see FiberContainer::update_resolution
+    struct {
+        bool adaptive = false;
+        int min_nodes = 8;
+        int max_nodes = 128;
+        double max_spacing = 0.1;
+        double max_angle = 0.2;
+        double coarsen_margin = 0.5;
+    } fiber_resolution;
+
+    /// Trajectory output. Split into segments listed in skelly_sim.manifest if either limit is set. @see System::write
+    struct {
+        int segment_frames = 0; ///< Start a new segment after this many frames. 0 for no limit
+        long segment_bytes = 0; ///< Start a new segment once any rank's file reaches this size. 0 for no limit
+    } trajectory;
+
+    /// Restart checkpoints, written separately from the trajectory. @see System::write_checkpoint
+    struct {
+        std::string file = "skelly_sim.checkpoint"; ///< Per-rank files are <file>.<rank>
+        double interval = 0.0;                      ///< Wall seconds between periodic checkpoints. 0 disables
+        double walltime = 0.0; ///< Checkpoint and stop before this many wall seconds have elapsed. 0 disables
+        bool on_signal = true; ///< Checkpoint and stop after the current step on SIGUSR1/SIGTERM
+    } checkpoint;
+
+    /// Live per-step telemetry in shared memory, read by skelly_top. @see telemetry::Publisher
+    struct {
+        bool enabled = false;
+        std::string name = "skelly_sim"; ///< Shared memory objects are /<name>.<rank>
+        int capacity = 4096;             ///< Records kept per rank. At least 2
+        int rss_interval = 100;          ///< Steps between samples of the resident set size
+    } telemetry;
+
+    /// Timeline of solver phases, FMM calls, preconditioner blocks and MPI collectives. @see trace::dump
+    struct {
+        bool enabled = false;
+        std::string file = "skelly_sim.trace.json"; ///< Chrome trace-event JSON, written with MPI-IO at exit
+        long max_events = 1000000;                   ///< Events buffered per thread. Later events are dropped
+    } trace;
+
     std::string shell_precompute_file;
 
     Params() = default;
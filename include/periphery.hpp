@@ -8,6 +8,8 @@
 
 #include <kernels.hpp>
 #include <params.hpp>
+#include <spherical_harmonics.hpp>
+#include <utils.hpp>
 
 class SphericalBody;
 
@@ -19,14 +21,15 @@ class Periphery {
   public:
     Periphery() = default;
     Periphery(const std::string &precompute_file, const toml::value &body_table, const Params &params);
+    virtual ~Periphery() = default;
 
-    Eigen::MatrixXd flow(MatrixRef &trg, MatrixRef &density, double eta) const;
+    Eigen::MatrixXd flow(MatrixRef &trg, MatrixRef &density, double eta, bool single_precision = false) const;
 
     /// @brief Get the number of nodes local to the MPI rank
-    int get_local_node_count() const { return M_inv_.rows() / 3; };
+    int get_local_node_count() const { return get_local_solution_size() / 3; };
 
     /// @brief Get the size of the shell's contribution to the matrix problem solution
-    int get_local_solution_size() const { return M_inv_.rows(); };
+    int get_local_solution_size() const { return n_nodes_global_ ? node_counts_[world_rank_] : 0; };
 
     Eigen::MatrixXd get_local_node_positions() const { return node_pos_; };
 
@@ -34,17 +37,24 @@ class Periphery {
 
     Eigen::VectorXd get_RHS() const { return RHS_; };
 
-    Eigen::VectorXd apply_preconditioner(VectorRef &x) const;
-    Eigen::VectorXd matvec(VectorRef &x_local, MatrixRef &v_local) const;
+    virtual Eigen::VectorXd apply_preconditioner(VectorRef &x, bool single_precision = false) const;
+    virtual Eigen::VectorXd matvec(VectorRef &x_local, MatrixRef &v_local, bool single_precision = false) const;
 
     /// pointer to FMM object (pointer to avoid constructing object with empty Periphery)
     std::shared_ptr<kernels::FMM<stkfmm::Stk3DFMM>> stresslet_kernel_;
-    Eigen::MatrixXd M_inv_;                        ///< Process local elements of inverse matrix
-    Eigen::MatrixXd stresslet_plus_complementary_; ///< Process local elements of stresslet tensor
+    /// Lower multipole order stresslet_kernel_ for the inner operator of Solver::solve_mixed_precision (unset otherwise)
+    std::shared_ptr<kernels::FMM<stkfmm::Stk3DFMM>> stresslet_kernel_low_;
+    CRowMatrixMap M_inv_{nullptr, 0, 0};                        ///< Process local rows of inverse matrix
+    CRowMatrixMap stresslet_plus_complementary_{nullptr, 0, 0}; ///< Process local rows of stresslet tensor
+    /// Single precision copy of M_inv_, for the inner solves of Solver::solve_mixed_precision (empty otherwise)
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> M_inv_f_;
+    /// Single precision copy of stresslet_plus_complementary_, for the inner operator of Solver::solve_mixed_precision
+    Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> stresslet_plus_complementary_f_;
     Eigen::MatrixXd node_pos_ = Eigen::MatrixXd(3, 0); ///< [3xn_nodes_local] matrix representing node positions
     Eigen::MatrixXd node_normal_;        ///< [3xn_nodes_local] matrix representing node normal vectors (inward facing)
     Eigen::VectorXd quadrature_weights_; ///< [n_nodes] array of 'far-field' quadrature weights
     Eigen::VectorXd RHS_;                ///< Current 'right-hand-side' for matrix formulation of solver
+    Eigen::VectorXd solution_vec_;       ///< Process local density from the last solve (empty before the first)
 
     /// MPI_WORLD_SIZE array that specifies node_counts_[i] = number_of_nodes_on_rank_i*3
     Eigen::VectorXi node_counts_;
@@ -74,11 +84,32 @@ class Periphery {
     };
 
     int n_nodes_global_ = 0; ///< Number of nodes across ALL MPI ranks
-  private:
+    /// [n_nodes_global_] index in the precompute file (or grid) of each global node, for output in the original order
+    Eigen::VectorXi node_order_;
+
+  protected:
+    Periphery(const Params &params);
+    void partition_nodes(int n_nodes);
+    Eigen::VectorXd gather_density(VectorRef &x_local) const;
+
     int world_size_;
     int world_rank_ = -1;
+
+  private:
+    /// Storage of M_inv_: local rows only, or the whole matrix once per node with node_shared_operators
+    utils::SharedBuffer M_inv_buf_;
+    utils::SharedBuffer stresslet_plus_complementary_buf_; ///< Storage of stresslet_plus_complementary_
 };
 
+/// @brief Spherical periphery, with either the precomputed dense operators or a vector spherical harmonic fast path
+///
+/// With `representation = "spherical_harmonics"` in the periphery table, the nodes are the Gauss-Legendre grid of a
+/// VectorSHT of degree `sh_order` and no precompute file is used. On a sphere the shell operator (stresslet with
+/// singularity subtraction, jump term and complementary kernel, as assembled by make_precompute_data.py) is block
+/// diagonal in vector spherical harmonics: per degree l, a 2x2 block couples the radial and poloidal coefficients
+/// and the toroidal coefficient is scaled. matvec and apply_preconditioner then apply the operator and its exact
+/// inverse by transforms, in O(N^{3/2}) time and O(N) memory, instead of with dense O(N^2) row blocks. Components of
+/// a grid field beyond the degree p band limit get the operator's high degree limit $-1 + 1/(2\eta)$.
 class SphericalPeriphery : public Periphery {
   public:
     double radius_;
@@ -86,9 +117,30 @@ class SphericalPeriphery : public Periphery {
         : Periphery(precompute_file, periphery_table, params) {
         radius_ = toml::find_or<double>(periphery_table, "radius", 0.0);
     };
+    SphericalPeriphery(const toml::value &periphery_table, const Params &params);
 
     virtual bool check_collision(const SphericalBody &body, double threshold) const;
     virtual bool check_collision(const MatrixRef &point_cloud, double threshold) const;
+
+    virtual Eigen::VectorXd apply_preconditioner(VectorRef &x, bool single_precision = false) const;
+    virtual Eigen::VectorXd matvec(VectorRef &x_local, MatrixRef &v_local, bool single_precision = false) const;
+
+    /// Ratio of node radius to attachment radius. Matches periphery_node_scale_factor of make_precompute_data.py
+    static constexpr double node_scale_factor = 1.04;
+
+    /// Per-degree operator blocks of the spectral representation
+    static Eigen::Matrix2d get_poloidal_block(int l, double eta, double node_radius);
+    static double get_toroidal_eigenvalue(int l, double eta);
+
+  private:
+    VectorSHT sht_;                               ///< Transforms on the node grid. Unset for the dense operators
+    Eigen::VectorXd grid_weights_;                ///< [n_nodes_global_] quadrature weights in grid order
+    std::vector<Eigen::Matrix2d> poloidal_;       ///< [p + 1] radial/poloidal operator block per degree
+    std::vector<Eigen::Matrix2d> poloidal_inv_;   ///< [p + 1] inverses of poloidal_
+    Eigen::VectorXd toroidal_;                    ///< [p + 1] toroidal operator eigenvalue per degree
+    double high_degree_ = 0.0;                    ///< Operator eigenvalue beyond the band limit
+
+    Eigen::VectorXd apply_spectral(VectorRef &x_local, bool inverse) const;
 };
 
 #endif
@@ -0,0 +1,109 @@
+#ifndef SCREENED_STOKESLET_HPP
+#define SCREENED_STOKESLET_HPP
+
+#include <skelly_sim.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/// @file
+/// @brief Stokeslet sums truncated at a cutoff, evaluated by direct sums over a cell list instead of the FMM
+
+/// @brief Uniform grid of cubic cells, at least the cutoff wide, binning a fixed set of points
+///
+/// Every point within the cutoff of a position lies in the 27 cells around it, so neighbor searches visit a superset of
+/// the true neighbors and callers test the distance themselves.
+class CellList {
+  public:
+    CellList() = default;
+    CellList(MatrixRef &points, double cutoff);
+
+    /// @brief Call f(j) for every point j in the cells around r, a superset of the points within the cutoff
+    template <typename F>
+    void for_each_candidate(const Eigen::Vector3d &r, F &&f) const {
+        if (point_index_.empty())
+            return;
+        int lo[3], hi[3];
+        for (int k = 0; k < 3; ++k) {
+            const double s = std::floor((r[k] - origin_[k]) / cell_size_);
+            if (s < -1.0 || s > n_cells_[k])
+                return;
+            lo[k] = std::max(int(s) - 1, 0);
+            hi[k] = std::min(int(s) + 1, n_cells_[k] - 1);
+        }
+        for (int ix = lo[0]; ix <= hi[0]; ++ix)
+            for (int iy = lo[1]; iy <= hi[1]; ++iy)
+                for (int iz = lo[2]; iz <= hi[2]; ++iz) {
+                    const int cell = (ix * n_cells_[1] + iy) * n_cells_[2] + iz;
+                    for (int i = cell_start_[cell]; i < cell_start_[cell + 1]; ++i)
+                        f(point_index_[i]);
+                }
+    }
+
+  private:
+    Eigen::Vector3d origin_;      ///< Lower corner of the grid
+    double cell_size_ = 0.0;      ///< Cell width, at least the cutoff
+    int n_cells_[3] = {0, 0, 0};  ///< Cells along each axis
+    std::vector<int> cell_start_; ///< [n_cells + 1] offsets of each cell's points in point_index_
+    std::vector<int> point_index_; ///< Point indices, sorted by cell
+};
+
+/// @brief Stokeslet sums over source-target pairs closer than a cutoff, across MPI ranks
+///
+/// Each rank receives a halo: the sources of other ranks inside the bounding box of its targets, grown by the cutoff.
+/// The sources are then binned in a CellList, and each target sums over its neighbors directly. Like kernels::FMM,
+/// the halo and the cell list are kept while no rank's sources or targets move, so repeated calls within a solve
+/// only exchange densities. Calls are collective.
+///
+/// The kernel is the singular stokeslet times a screening factor \f$ S(r) \f$, which is 1 up to
+/// \f$ (1 - \textrm{taper}) r_c \f$, falls smoothly (\f$ C^1 \f$) to 0 at the cutoff \f$ r_c \f$, and is 0 beyond.
+/// taper = 0 is a sharp truncation.
+class ScreenedStokeslet {
+  public:
+    ScreenedStokeslet(double cutoff, double taper) : cutoff_(cutoff), taper_(taper){};
+
+    /// @brief Screened velocity of the sources at the targets
+    /// @param[in] r_src [ 3 x n_src ] local source positions
+    /// @param[in] density [ 3 x n_src ] local source strengths (force times quadrature weight)
+    /// @param[in] src_group [ n_src ] group of each source. Ids must be unique across ranks
+    /// @param[in] r_trg [ 3 x n_trg ] local target positions
+    /// @param[in] trg_group [ n_trg ] group of each target. Sources of the same group are skipped. -1 for none
+    /// @param[in] eta viscosity
+    /// @return [ 3 x n_trg ] velocities at r_trg
+    Eigen::MatrixXd operator()(MatrixRef &r_src, MatrixRef &density, const std::vector<long> &src_group,
+                               MatrixRef &r_trg, const std::vector<long> &trg_group, double eta);
+
+    /// @brief Screening factor \f$ S(r) \f$
+    double screening(double r) const {
+        if (r >= cutoff_)
+            return 0.0;
+        const double r_inner = (1.0 - taper_) * cutoff_;
+        if (r <= r_inner)
+            return 1.0;
+        const double x = (r - r_inner) / (cutoff_ - r_inner);
+        return 1.0 - x * x * (3.0 - 2.0 * x);
+    }
+
+    /// @brief Number of sources received from other ranks in the current halo
+    int get_halo_size() const { return r_halo_.cols(); }
+
+  private:
+    void update_halo(MatrixRef &r_src, const std::vector<long> &src_group, MatrixRef &r_trg);
+
+    double cutoff_; ///< Interaction range
+    double taper_;  ///< Fraction of the cutoff over which the screening falls from 1 to 0
+
+    Eigen::MatrixXd r_src_old_; ///< Sources the halo was built for
+    Eigen::MatrixXd r_trg_old_; ///< Targets the halo was built for
+    bool has_halo_ = false;     ///< Set once the halo was built
+
+    std::vector<int> send_index_;  ///< Local sources sent to each rank, grouped by destination rank
+    std::vector<int> send_counts_; ///< [world_size] sources sent to each rank
+    std::vector<int> recv_counts_; ///< [world_size] sources received from each rank
+    Eigen::MatrixXd r_halo_;       ///< [ 3 x n_halo ] received source positions
+    std::vector<long> group_halo_; ///< [ n_halo ] received source groups
+    CellList cells_;               ///< Local sources followed by the halo
+};
+
+#endif
@@ -17,6 +17,8 @@ typedef Eigen::Map<Eigen::ArrayXd> ArrayMap;
 typedef Eigen::Map<const Eigen::ArrayXd> CArrayMap;
 typedef Eigen::Map<Eigen::MatrixXd> MatrixMap;
 typedef Eigen::Map<const Eigen::MatrixXd> CMatrixMap;
+typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> RowMatrixXd;
+typedef Eigen::Map<const RowMatrixXd> CRowMatrixMap;
 typedef const Eigen::Ref<const Eigen::ArrayXd> ArrayRef;
 typedef const Eigen::Ref<const Eigen::VectorXd> VectorRef;
 typedef const Eigen::Ref<const Eigen::MatrixXd> MatrixRef;
@@ -0,0 +1,52 @@
+#ifndef SKELLY_TRAJ_H
+#define SKELLY_TRAJ_H
+
+/* C interface to libskelly_traj, for use from ctypes/cffi (see utils/paraview_utils/skelly_traj.py).
+ *
+ * Usage:
+ *   skelly_traj_t *traj = skelly_traj_open("skelly_sim.out"); // or "skelly_sim.manifest" for segmented output
+ *   skelly_traj_frame_t frame;
+ *   skelly_traj_load_frame(traj, 10, &frame);
+ *   ... frame.fiber_x[3 * frame.fiber_offsets[i]] is the first node of fiber i ...
+ *   skelly_traj_close(traj);
+ *
+ * Array pointers in a frame are owned by the handle and stay valid until the next load_frame or close call.
+ * Functions returning int return 0 on success and nonzero on failure, with the reason in skelly_traj_last_error().
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct skelly_traj_handle skelly_traj_t;
+
+typedef struct {
+    double time;
+    double dt;
+    int64_t n_fibers;
+    int64_t n_nodes;                      /* total fiber nodes */
+    const int32_t *fiber_n_nodes;         /* [n_fibers] */
+    const int64_t *fiber_offsets;         /* [n_fibers + 1] */
+    const double *fiber_length;           /* [n_fibers] */
+    const double *fiber_bending_rigidity; /* [n_fibers] */
+    const int32_t *fiber_binding_site;    /* [2 * n_fibers] */
+    const double *fiber_x;                /* [3 * n_nodes] */
+    int64_t n_bodies;
+    const double *body_position;    /* [3 * n_bodies] */
+    const double *body_orientation; /* [4 * n_bodies], (w, x, y, z) */
+} skelly_traj_frame_t;
+
+skelly_traj_t *skelly_traj_open(const char *prefix);
+void skelly_traj_close(skelly_traj_t *traj);
+int64_t skelly_traj_n_frames(const skelly_traj_t *traj);
+int64_t skelly_traj_n_ranks(const skelly_traj_t *traj);
+int skelly_traj_load_frame(skelly_traj_t *traj, int64_t i_frame, skelly_traj_frame_t *frame);
+const char *skelly_traj_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
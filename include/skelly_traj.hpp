@@ -0,0 +1,91 @@
+#ifndef SKELLY_TRAJ_HPP
+#define SKELLY_TRAJ_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// @file
+/// @brief Random access reader for SkellySim trajectories (skelly_sim.out.<rank>)
+///
+/// Standalone: depends only on msgpack-c, so it can be built into libskelly_traj without MPI or the solver stack.
+
+namespace skelly_traj {
+
+/// @brief One frame of a trajectory, with every rank's fibers concatenated into flat arrays
+///
+/// Fiber i has fiber_n_nodes[i] nodes, stored as xyz triplets in
+/// fiber_x[3 * fiber_offsets[i]] ... fiber_x[3 * fiber_offsets[i + 1] - 1].
+struct Frame {
+    double time = 0.0;
+    double dt = 0.0;
+    std::vector<int32_t> fiber_n_nodes;      ///< [n_fibers]
+    std::vector<int64_t> fiber_offsets;      ///< [n_fibers + 1] first node of each fiber
+    std::vector<double> fiber_length;        ///< [n_fibers]
+    std::vector<double> fiber_bending_rigidity; ///< [n_fibers]
+    std::vector<int32_t> fiber_binding_site; ///< [2 * n_fibers] (body, site) pairs, -1 when unbound
+    std::vector<double> fiber_x;             ///< [3 * n_nodes_total]
+    std::vector<double> body_position;       ///< [3 * n_bodies]
+    std::vector<double> body_orientation;    ///< [4 * n_bodies] quaternions as (w, x, y, z)
+
+    std::size_t n_fibers() const { return fiber_n_nodes.size(); }
+    std::size_t n_bodies() const { return body_position.size() / 3; }
+    void clear();
+    void append_fibers(const Frame &other);
+};
+
+/// @brief Memory mapped view of one rank's trajectory file, with the byte offset of every frame
+class RankFile {
+  public:
+    RankFile(const std::string &filename);
+    RankFile(const RankFile &) = delete;
+    RankFile &operator=(const RankFile &) = delete;
+    ~RankFile();
+
+    std::size_t n_frames() const { return offsets_.size(); }
+    void read_frame(std::size_t i_frame, Frame &frame, bool with_bodies) const;
+
+  private:
+    std::string filename_;
+    const char *addr_ = nullptr;   ///< mmap of the file
+    std::size_t size_ = 0;         ///< size of the mapping in bytes
+    std::vector<uint64_t> offsets_; ///< byte offset of each complete frame
+    uint64_t indexed_end_ = 0;      ///< byte offset of the end of the last complete frame
+
+    void build_index();
+    bool load_index(const std::string &index_file);
+    void save_index(const std::string &index_file) const;
+};
+
+/// @brief All rank files of one simulation, possibly split into segments
+///
+/// Frames are indexed once per rank file. The index is cached next to the trajectory in
+/// <file>.idx and extended incrementally if the trajectory has grown since, so reopening a
+/// trajectory only scans frames written after the last open.
+class Trajectory {
+  public:
+    Trajectory(const std::string &path);
+
+    std::size_t n_frames() const { return n_frames_; }
+    std::size_t n_ranks() const { return segments_.front().files.size(); }
+    std::size_t n_segments() const { return segments_.size(); }
+    void read_frame(std::size_t i_frame, Frame &frame) const;
+
+  private:
+    /// Rank files sharing one prefix
+    struct segment_t {
+        std::vector<std::unique_ptr<RankFile>> files;
+        std::size_t first_frame = 0; ///< Index of the segment's first frame in the trajectory
+        std::size_t n_frames = 0;    ///< Number of frames complete on every rank
+    };
+    std::vector<segment_t> segments_;
+    std::size_t n_frames_ = 0; ///< Total frames over all segments
+
+    void add_segment(const std::string &prefix);
+};
+
+} // namespace skelly_traj
+
+#endif
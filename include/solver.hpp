@@ -27,7 +27,11 @@ class Solver {
     };
     void set_RHS();
     bool solve();
+    bool solve_mixed_precision();
+    bool solve_direct();
     void apply_preconditioner();
+    int get_n_iterations() const { return n_iterations_; };
+    Tpetra::global_size_t get_global_size() const { return map_->getGlobalNumElements(); };
     CVectorMap get_solution() { return CVectorMap(X_->getData(0).getRawPtr(), X_->getLocalLength()); };
     double get_residual() {
         Teuchos::RCP<SV> Y(new SV(map_));
@@ -46,6 +50,7 @@ class Solver {
     Teuchos::RCP<SV> X_;
     Teuchos::RCP<SV> RHS_;
     Teuchos::RCP<const Tpetra::Map<>> map_;
+    int n_iterations_ = 0; ///< Krylov iterations of the last solve
 };
 
 #endif
@@ -0,0 +1,48 @@
+#ifndef SPHERICAL_HARMONICS_HPP
+#define SPHERICAL_HARMONICS_HPP
+
+#include <skelly_sim.hpp>
+
+/// @brief Vector spherical harmonic transforms on a Gauss-Legendre by equispaced longitude grid
+///
+/// A vector field on the unit sphere, band limited to degree p, is expanded as
+/// \f[ f = \sum_{l \le p} \sum_{|m| \le l} a_{lm} Y_{lm} \hat{r} + b_{lm} \nabla_s Y_{lm} +
+///         c_{lm} \hat{r} \times \nabla_s Y_{lm} \f]
+/// with orthonormal \f$Y_{lm}\f$. The grid has p + 1 Gauss-Legendre latitudes and 2p + 2 longitudes, so N = 2(p + 1)^2
+/// nodes, and the analysis quadrature is exact for band limited fields. Longitude transforms are dense products with a
+/// precomputed Fourier matrix and Legendre functions are recomputed by recurrence on every transform, so both
+/// transforms cost O(p^3) = O(N^{3/2}) with O(N) memory.
+class VectorSHT {
+  public:
+    /// Coefficients for m >= 0, indexed (l, m) and zero for m > l. Real fields have \f$c_{l,-m} = \bar{c}_{lm}\f$
+    struct coeffs_t {
+        Eigen::MatrixXcd a; ///< Radial coefficients
+        Eigen::MatrixXcd b; ///< Poloidal (surface gradient) coefficients, zero for l = 0
+        Eigen::MatrixXcd c; ///< Toroidal (surface curl) coefficients, zero for l = 0
+    };
+
+    VectorSHT() = default;
+    VectorSHT(int order);
+
+    int get_order() const { return p_; };
+    int get_n_nodes() const { return n_lat_ * n_lon_; };
+    Eigen::MatrixXd get_nodes() const;
+    Eigen::VectorXd get_weights() const;
+
+    coeffs_t analyze(MatrixRef &f) const;
+    Eigen::MatrixXd synthesize(const coeffs_t &coeffs) const;
+
+  private:
+    int p_ = -1;    ///< Maximum degree
+    int n_lat_ = 0; ///< Number of latitudes, p + 1
+    int n_lon_ = 0; ///< Number of longitudes, 2p + 2
+    Eigen::VectorXd cos_theta_;  ///< [n_lat] Gauss-Legendre nodes, north to south
+    Eigen::VectorXd sin_theta_;  ///< [n_lat]
+    Eigen::VectorXd gl_weights_; ///< [n_lat] Gauss-Legendre weights
+    Eigen::VectorXd phi_;        ///< [n_lon] longitudes
+    Eigen::MatrixXcd fourier_;   ///< [n_lon x p + 1] \f$e^{-i m \phi_k}\f$
+
+    void legendre(int m, int j, Eigen::VectorXd &P, Eigen::VectorXd &dP) const;
+};
+
+#endif
@@ -10,22 +10,42 @@ class Periphery;
 
 /// Namespace for System, which drives the simulation and handles communication (timestepping, data wrangling, etc)
 namespace System {
+/// @brief Solver statistics and phase timings of a step
+struct StepStats {
+    int gmres_iterations = 0;   ///< GMRES iterations of the solve, zero for direct and IMEX solves
+    double residual = 0.0;      ///< Final residual of the solve
+    double imex_residual = 0.0; ///< Coupled residual of the IMEX sweep, zero without one. @see Params::imex
+    double t_setup = 0.0;       ///< Wall time building operators and right-hand sides
+    double t_solve = 0.0;       ///< Wall time of the solve
+    double t_update = 0.0;      ///< Wall time updating the state with the solution
+};
+
+/// @brief Time varying system properties that are extrinsic to the physical objects
+struct Properties {
+    double dt;            ///< Current timestep size
+    double time = 0.0;    ///< Current system time
+    double dt_prev = 0.0; ///< Size of the last accepted step, 0 if the next step has no history to use
+};
+
 void init(const std::string &input_file, bool resume_flag = false);
 Params *get_params();
 BodyContainer *get_body_container();
 FiberContainer *get_fiber_container();
 Periphery *get_shell();
 toml::value *get_param_table();
+const StepStats &get_step_stats();
+Properties *get_properties();
 
 std::pair<Eigen::MatrixXd, Eigen::MatrixXd> calculate_body_fiber_link_conditions(VectorRef &fibers_xt,
                                                                                  MatrixRef &body_velocities);
 std::tuple<int, int, int> get_local_solution_sizes();
-Eigen::VectorXd apply_preconditioner(VectorRef &x);
-Eigen::VectorXd apply_matvec(VectorRef &x);
+Eigen::VectorXd apply_preconditioner(VectorRef &x, bool single_precision = false);
+Eigen::VectorXd apply_matvec(VectorRef &x, bool single_precision = false);
 void dynamic_instability();
 bool step();
 void run();
 bool check_collision();
+bool check_local_collision();
 void backup();
 void restore();
 Eigen::VectorXd get_fiber_RHS();
@@ -0,0 +1,74 @@
+#ifndef TELEMETRY_HPP
+#define TELEMETRY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/// @file
+/// @brief Live per-step telemetry in POSIX shared memory
+///
+/// Each rank owns one shared memory object, /<name>.<rank>, holding a header and a ring of fixed size records.
+/// The simulation only ever writes to its own memory, so monitoring (see skelly_top) never touches its I/O path.
+/// Shared memory is node local: skelly_top sees the ranks running on the node it is started on.
+
+namespace telemetry {
+
+constexpr char magic[8] = {'S', 'K', 'T', 'E', 'L', 'E', 'M', '1'};
+
+/// @brief One record per timestep attempt, accepted or not
+struct record_t {
+    uint64_t step;             ///< Step attempts since the start of this run
+    double time;               ///< System time after the step
+    double dt;                 ///< Timestep size used by the step
+    double wall_time;          ///< Wall clock (seconds since epoch) at the end of the step
+    int32_t accepted;          ///< 1 if the step was accepted
+    int32_t gmres_iterations;  ///< Krylov iterations, 0 if the step was solved without GMRES
+    double residual;           ///< Residual of the linear solve
+    double t_step;             ///< Wall seconds for the whole step
+    double t_setup;            ///< Wall seconds building operators and right hand sides
+    double t_solve;            ///< Wall seconds in the linear solve
+    double t_update;           ///< Wall seconds applying the solution
+    int64_t n_fibers;          ///< Local fibers
+    int64_t n_fiber_nodes;     ///< Local fiber nodes
+    int64_t rss_bytes;         ///< Resident set size of the rank
+};
+
+/// @brief Start of each shared memory object, followed by capacity records
+struct header_t {
+    char magic[8];
+    uint32_t record_size;         ///< sizeof(record_t), to catch mismatched builds
+    uint32_t capacity;            ///< Number of records in the ring
+    int32_t rank;
+    int32_t n_ranks;
+    int64_t pid;
+    std::atomic<uint64_t> head; ///< Records written so far. The latest is at (head - 1) % capacity
+};
+
+/// @brief Name of the shared memory object for a rank
+inline std::string shm_name(const std::string &name, int rank) { return "/" + name + "." + std::to_string(rank); }
+
+/// @brief Writer side of a rank's telemetry ring
+class Publisher {
+  public:
+    Publisher() = default;
+    Publisher(const std::string &name, int rank, int n_ranks, uint32_t capacity);
+    Publisher(const Publisher &) = delete;
+    Publisher &operator=(const Publisher &) = delete;
+    ~Publisher();
+
+    bool is_open() const { return header_ != nullptr; }
+    void publish(record_t record);
+
+  private:
+    std::string shm_name_;
+    header_t *header_ = nullptr;
+    record_t *records_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+int64_t get_rss_bytes();
+
+} // namespace telemetry
+
+#endif
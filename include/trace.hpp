@@ -0,0 +1,57 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <cstdint>
+#include <string>
+
+/// @file
+/// @brief Optional per-rank, per-thread event tracing, written in the Chrome trace-event JSON format
+///
+/// Events are buffered in memory by the thread that records them and written once, by System::run() at exit, to a
+/// single file that can be opened offline in chrome://tracing or https://ui.perfetto.dev. Ranks are processes and
+/// threads are threads in the viewer. When tracing is disabled a TRACE_SCOPE costs one branch.
+
+namespace trace {
+
+extern bool enabled_; ///< Set by start(). Read on every scope, so kept out of any function call
+
+/// @brief Enable tracing. Collective: ranks share a time origin taken after a barrier
+/// @param[in] max_events events kept per thread. Later events are dropped and counted
+void start(std::size_t max_events);
+
+/// @brief Nanoseconds since the time origin
+int64_t now_ns();
+
+/// @brief Buffer one complete event for the calling thread
+/// @param[in] name,category must outlive the trace (string literals)
+void record(const char *name, const char *category, int64_t begin_ns, int64_t end_ns);
+
+/// @brief Write every rank's events to filename with MPI-IO. Collective. No-op if tracing is disabled
+void dump(const std::string &filename);
+
+/// @brief RAII guard recording an event from construction to destruction
+class Scope {
+  public:
+    Scope(const char *name, const char *category)
+        : name_(name), category_(category), begin_ns_(enabled_ ? now_ns() : -1) {}
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+    ~Scope() {
+        if (begin_ns_ >= 0)
+            record(name_, category_, begin_ns_, now_ns());
+    }
+
+  private:
+    const char *name_;
+    const char *category_;
+    int64_t begin_ns_;
+};
+
+} // namespace trace
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+/// @brief Trace the rest of the enclosing block as one event
+#define TRACE_SCOPE(name, category) trace::Scope TRACE_CONCAT(trace_scope_, __LINE__)(name, category)
+
+#endif
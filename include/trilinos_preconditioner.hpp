@@ -0,0 +1,48 @@
+#ifndef TRILINOS_PRECONDITIONER_HPP
+#define TRILINOS_PRECONDITIONER_HPP
+
+#include <skelly_sim.hpp>
+
+#include <Ifpack2_Preconditioner.hpp>
+#include <Teuchos_ParameterList.hpp>
+#include <Tpetra_CrsMatrix.hpp>
+#include <Tpetra_Map.hpp>
+
+/// @brief Optional Ifpack2 replacement for the per-fiber and per-body LU blocks of the System preconditioner
+///
+/// The fiber operators (Fiber::A_, after the boundary conditions are applied) and the body operators are assembled
+/// into one distributed Tpetra::CrsMatrix, fibers first then bodies, with the rank's rows in solution vector order.
+/// Every block lives on one rank, so the matrix is block diagonal and any Ifpack2 preconditioner (ILU(k), ILUT,
+/// relaxation, block relaxation, additive Schwarz, ...) applies to it. The shell keeps its dense inverse.
+///
+/// The incomplete factorizations (RILUK, ILUT) do not pivot, and break down on fiber operators, whose tension rows
+/// have zero diagonals. "BLOCK RELAXATION" with dense containers factors each block with partial pivoting, like the
+/// default LU path, and is partitioned into the assembled blocks unless the parameters give a partitioner.
+class TrilinosPreconditioner {
+  public:
+    typedef Tpetra::CrsMatrix<> matrix_type;
+    typedef Tpetra::RowMatrix<> row_matrix_type;
+    typedef Ifpack2::Preconditioner<> prec_type;
+    typedef matrix_type::local_ordinal_type LO;
+    typedef matrix_type::global_ordinal_type GO;
+
+    TrilinosPreconditioner() = default;
+    TrilinosPreconditioner(const std::string &type, const toml::value &parameters);
+
+    bool is_enabled() const { return !type_.empty(); };
+    void update();
+    void update(const std::vector<const Eigen::MatrixXd *> &blocks);
+    Eigen::VectorXd apply(VectorRef &x) const;
+
+  private:
+    std::string type_;                      ///< Ifpack2 preconditioner name, empty if disabled
+    Teuchos::ParameterList parameters_;     ///< Ifpack2 parameters from the config
+    Teuchos::RCP<const Tpetra::Map<>> map_; ///< Row map: local fiber unknowns then local body unknowns
+    Teuchos::RCP<matrix_type> A_;           ///< Assembled fiber and body operators
+    Teuchos::RCP<prec_type> prec_;          ///< Ifpack2 preconditioner of A_
+
+    mutable double apply_time_ = 0.0; ///< Wall time in apply() since the last update()
+    mutable long n_applies_ = 0;      ///< Calls to apply() since the last update()
+};
+
+#endif
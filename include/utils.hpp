@@ -2,7 +2,10 @@
 #define UTILS_HPP
 
 #include <skelly_sim.hpp>
+#include <memory>
+#include <mpi.h>
 #include <spdlog/spdlog.h>
+#include <vector>
 
 namespace cnpy {
 struct NpyArray;
@@ -12,6 +15,7 @@ using npz_t = std::map<std::string, NpyArray>;
 namespace utils {
 Eigen::MatrixXd finite_diff(ArrayRef &s, int M, int n_s);
 Eigen::VectorXd collect_into_global(VectorRef &local_vec);
+std::vector<int> morton_order(MatrixRef &points);
 
 Eigen::MatrixXd load_mat(cnpy::npz_t &npz, const char *var);
 Eigen::VectorXd load_vec(cnpy::npz_t &npz, const char *var);
@@ -24,6 +28,35 @@ bool allclose(
     return ((a.derived() - b.derived()).array().abs() <= (atol + rtol * b.derived().array().abs())).all();
 }
 
+MPI_Comm get_node_comm();
+MPI_Comm get_node_leader_comm();
+
+/// @brief Read-only array of doubles, stored privately or once per compute node in an MPI-3 shared memory window
+///
+/// In shared mode the allocation belongs to the node-local rank 0, and every rank on the node gets a pointer into it.
+/// Only ranks with is_writer() should fill the data, and all ranks must call sync() before reading it. Copies of the
+/// object share the allocation, which is released with the last copy.
+class SharedBuffer {
+  public:
+    SharedBuffer() = default;
+    SharedBuffer(size_t size, bool node_shared);
+
+    double *data() { return ptr_; }
+    const double *data() const { return ptr_; }
+    size_t size() const { return size_; }
+    bool is_shared() const { return bool(window_); }
+    bool is_writer() const;
+    void broadcast_from_root();
+    void sync() const;
+
+  private:
+    struct window_t;
+    std::shared_ptr<window_t> window_;          ///< MPI window handle, if shared
+    std::shared_ptr<std::vector<double>> data_; ///< private storage, if not shared
+    double *ptr_ = nullptr;
+    size_t size_ = 0;
+};
+
 class LoggerRedirect {
   public:
     LoggerRedirect(std::ostream &in) : m_orig(in), m_old_buffer(in.rdbuf(ss.rdbuf())) {}
@@ -6,6 +6,7 @@
 #include <kernels.hpp>
 #include <parse_util.hpp>
 #include <periphery.hpp>
+#include <trace.hpp>
 #include <utils.hpp>
 
 #include <spdlog/spdlog.h>
@@ -28,14 +29,106 @@ void Body::update_K_matrix() {
 
 /// @brief Update internal variables that need to be recomputed only once after calling Body::move
 ///
+/// The body operator is invariant under translation and equivariant under rotation, so between full refreshes the
+/// singularity subtraction vectors are rotated from their values at the last refresh, and the refresh LU is reused
+/// in a rotated frame (@see apply_preconditioner). Body::K_ is rebuilt and Body::A_ is rotated to the new pose, which
+/// costs O(n^2) flops but no kernel evaluations. This is exact up to round-off. A full refresh, which rebuilds the
+/// operator from the stresslet kernel and refactorizes it, happens every refresh_interval calls. Nothing is done if the
+/// body has not moved since the last update.
+///
 /// @see update_singularity_subtraction_vecs
 /// @see update_K_matrix
 /// @see update_preconditioner
 /// @param[in] eta fluid viscosity
-void Body::update_cache_variables(double eta) {
-    update_singularity_subtraction_vecs(eta);
+/// @param[in] refresh_interval number of calls between full refreshes
+void Body::update_cache_variables(double eta, int refresh_interval) {
+    TRACE_SCOPE("body cache", "step");
+    if (cached_pose_.valid && cached_pose_.position == position_ &&
+        cached_pose_.orientation.coeffs() == orientation_.coeffs())
+        return;
+    cached_pose_ = {position_, orientation_, true};
+
+    if (refresh_.age < 0 || refresh_.age + 1 >= refresh_interval) {
+        update_singularity_subtraction_vecs(eta);
+        update_K_matrix();
+        update_preconditioner(eta);
+        refresh_.orientation = orientation_;
+        refresh_.ex = ex_;
+        refresh_.ey = ey_;
+        refresh_.ez = ez_;
+        refresh_.operator_orientation = orientation_;
+        refresh_.age = 0;
+        return;
+    }
+
+    // e_k(R) = R * sum_j R(k, j) e_j(refresh), from T_R(rho) = R T(R^T rho) for the stresslet operator T
+    const Eigen::Matrix3d R = get_rotation_since_refresh();
+    ex_ = R * (R(0, 0) * refresh_.ex + R(0, 1) * refresh_.ey + R(0, 2) * refresh_.ez);
+    ey_ = R * (R(1, 0) * refresh_.ex + R(1, 1) * refresh_.ey + R(1, 2) * refresh_.ez);
+    ez_ = R * (R(2, 0) * refresh_.ex + R(2, 1) * refresh_.ey + R(2, 2) * refresh_.ez);
     update_K_matrix();
-    update_preconditioner(eta);
+    A_ = rotate_operator(A_, (orientation_ * refresh_.operator_orientation.inverse()).toRotationMatrix());
+    refresh_.operator_orientation = orientation_;
+    refresh_.age++;
+}
+
+/// @brief Move the cache variables from the same body in a rejected step attempt
+///
+/// The restored body is at the pose the rejected attempt started from, so these are the caches for its current pose.
+/// @param[in, out] rejected body after the rejected attempt
+void Body::take_cache_variables(Body &rejected) {
+    ex_ = std::move(rejected.ex_);
+    ey_ = std::move(rejected.ey_);
+    ez_ = std::move(rejected.ez_);
+    K_ = std::move(rejected.K_);
+    A_ = std::move(rejected.A_);
+    A_LU_ = std::move(rejected.A_LU_);
+    refresh_ = std::move(rejected.refresh_);
+    cached_pose_ = rejected.cached_pose_;
+    rejected.cached_pose_.valid = false;
+}
+
+/// @brief Lab frame rotation of the body since its last full cache refresh
+Eigen::Matrix3d Body::get_rotation_since_refresh() const {
+    return (orientation_ * refresh_.orientation.inverse()).toRotationMatrix();
+}
+
+/// @brief Apply the body preconditioner, rotating into the frame of the last refresh if necessary
+///
+/// With \f$Q\f$ the block diagonal rotation since the refresh, \f$A = Q A_{\textrm{ref}} Q^T\f$, so
+/// \f[ A^{-1} x = Q A_{\textrm{ref}}^{-1} Q^T x \f]
+/// @param[in] x [3 * n_nodes + 6] vector of node densities, velocity and angular velocity
+/// @return [3 * n_nodes + 6] preconditioned vector
+Eigen::VectorXd Body::apply_preconditioner(VectorRef &x) const {
+    if (refresh_.age <= 0)
+        return A_LU_.solve(x);
+
+    const Eigen::Matrix3d R = get_rotation_since_refresh();
+    Eigen::VectorXd y(x.size());
+    Eigen::Map<Eigen::MatrixXd> y_mat(y.data(), 3, x.size() / 3);
+    y_mat = R.transpose() * CMatrixMap(x.data(), 3, x.size() / 3);
+    y = A_LU_.solve(y);
+    y_mat = R * y_mat;
+    return y;
+}
+
+/// @brief Body operator at the current pose
+/// @return [3 * n_nodes + 6, 3 * n_nodes + 6] operator
+Eigen::MatrixXd Body::get_operator() const { return A_; }
+
+/// @brief Rotate a body operator, \f$Q A Q^T\f$ with \f$Q\f$ the block diagonal rotation
+/// @param[in] A [3 * n_nodes + 6, 3 * n_nodes + 6] operator
+/// @param[in] R lab frame rotation
+/// @return [3 * n_nodes + 6, 3 * n_nodes + 6] rotated operator
+Eigen::MatrixXd Body::rotate_operator(const Eigen::MatrixXd &A, const Eigen::Matrix3d &R) {
+    const int n_blocks = A.rows() / 3;
+    Eigen::MatrixXd QA(A.rows(), A.cols());
+    for (int i = 0; i < n_blocks; ++i)
+        QA.middleRows(3 * i, 3) = R * A.middleRows(3 * i, 3);
+    Eigen::MatrixXd QAQt(A.rows(), A.cols());
+    for (int j = 0; j < n_blocks; ++j)
+        QAQt.middleCols(3 * j, 3) = QA.middleCols(3 * j, 3) * R.transpose();
+    return QAQt;
 }
 
 /// @brief Update the preconditioner and associated linear operator
@@ -67,6 +160,31 @@ void Body::update_preconditioner(double eta) {
     A_LU_.compute(A_);
 }
 
+/// @brief Apply this body's block of the matrix-free operator
+///
+/// @param[in] v_body [3 x n_nodes] velocities at the body nodes from every source
+/// @param[in] density [3 x n_nodes] body node densities
+/// @param[in] velocity [6] body velocity and angular velocity
+/// @return [3 * n_nodes + 6] body block of the operator applied to the solution
+Eigen::VectorXd Body::matvec(MatrixRef &v_body, MatrixRef &density, VectorRef &velocity) const {
+    Eigen::VectorXd res(get_solution_size());
+    Eigen::VectorXd cx = Eigen::VectorXd::Zero(3 * n_nodes_);
+    Eigen::VectorXd cy = Eigen::VectorXd::Zero(3 * n_nodes_);
+    Eigen::VectorXd cz = Eigen::VectorXd::Zero(3 * n_nodes_);
+    for (int i = 0; i < n_nodes_; ++i) {
+        cx.segment(i * 3, 3) += density(0, i) / node_weights_(i) * ex_.col(i);
+        cy.segment(i * 3, 3) += density(1, i) / node_weights_(i) * ey_.col(i);
+        cz.segment(i * 3, 3) += density(2, i) / node_weights_(i) * ez_.col(i);
+    }
+
+    Eigen::VectorXd KU = K_ * velocity;
+    Eigen::VectorXd KTLambda = K_.transpose() * CVectorMap(density.data(), 3 * n_nodes_);
+
+    res.head(3 * n_nodes_) = -(cx + cy + cz) - KU + CVectorMap(v_body.data(), 3 * n_nodes_);
+    res.tail(6) = -KTLambda + velocity;
+    return res;
+}
+
 /// @brief Calculate the current RHS_, given the current velocity on the body's nodes
 ///
 /// Updates only Body::RHS_
@@ -122,25 +240,45 @@ void Body::update_singularity_subtraction_vecs(double eta) {
 
 /// @brief Helper function that loads precompute data.
 ///
-/// Data is loaded on _every_ MPI rank, and should be identical.
+/// Data is needed on _every_ MPI rank, and should be identical. By default every rank reads the file, otherwise rank 0
+/// reads it and broadcasts.
 /// Updates: Body::node_positions_ref_, Body::node_normals_ref_, Body::node_weights_
 ///   @param[in] precompute_file path to file containing precompute data in npz format (from numpy.save). See associated
 ///   utility precompute script `utils/make_precompute_data.py`
-void Body::load_precompute_data(const std::string &precompute_file) {
-    cnpy::npz_t precomp = cnpy::npz_load(precompute_file);
-    auto load_mat = [](cnpy::npz_t &npz, const char *var) {
-        return Eigen::Map<Eigen::ArrayXXd>(npz[var].data<double>(), npz[var].shape[1], npz[var].shape[0]).matrix();
-    };
-
-    auto load_vec = [](cnpy::npz_t &npz, const char *var) {
-        return VectorMap(npz[var].data<double>(), npz[var].shape[0]);
-    };
+///   @param[in] root_only only read the file on rank 0
+void Body::load_precompute_data(const std::string &precompute_file, bool root_only) {
+    int rank = 0;
+    if (root_only)
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    if (rank == 0) {
+        cnpy::npz_t precomp = cnpy::npz_load(precompute_file);
+        auto load_mat = [](cnpy::npz_t &npz, const char *var) {
+            return Eigen::Map<Eigen::ArrayXXd>(npz[var].data<double>(), npz[var].shape[1], npz[var].shape[0]).matrix();
+        };
+
+        auto load_vec = [](cnpy::npz_t &npz, const char *var) {
+            return VectorMap(npz[var].data<double>(), npz[var].shape[0]);
+        };
+
+        node_positions_ref_ = load_mat(precomp, "node_positions_ref");
+        node_normals_ref_ = load_mat(precomp, "node_normals_ref");
+        node_weights_ = load_vec(precomp, "node_weights");
+        n_nodes_ = node_positions_ref_.cols();
+    }
 
-    node_positions_ = node_positions_ref_ = load_mat(precomp, "node_positions_ref");
-    node_normals_ = node_normals_ref_ = load_mat(precomp, "node_normals_ref");
-    node_weights_ = load_vec(precomp, "node_weights");
+    if (root_only) {
+        MPI_Bcast(&n_nodes_, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        node_positions_ref_.resize(3, n_nodes_);
+        node_normals_ref_.resize(3, n_nodes_);
+        node_weights_.resize(n_nodes_);
+        MPI_Bcast(node_positions_ref_.data(), 3 * n_nodes_, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        MPI_Bcast(node_normals_ref_.data(), 3 * n_nodes_, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        MPI_Bcast(node_weights_.data(), n_nodes_, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    }
 
-    n_nodes_ = node_positions_.cols();
+    node_positions_ = node_positions_ref_;
+    node_normals_ = node_normals_ref_;
 }
 
 /// @brief Construct body from relevant toml config and system params
@@ -150,14 +288,28 @@ void Body::load_precompute_data(const std::string &precompute_file) {
 ///   surface).
 ///   @return Body object that has been appropriately rotated. Other internal cache variables are _not_ updated.
 /// @see update_cache_variables
-Body::Body(const toml::value &body_table, const Params &params) {
-    using namespace parse_util;
+Body::Body(const toml::value &body_table, const Params &params) : Body(body_table) {
     using std::string;
     string precompute_file = toml::find<string>(body_table, "precompute_file");
-    load_precompute_data(precompute_file);
+    load_precompute_data(precompute_file, params.node_shared_operators);
 
     // TODO: add body assertions so that input file and precompute data necessarily agree
 
+    move(position_, orientation_);
+
+    // Body operators are only applied on rank 0. @see BodyContainer::update_cache_variables
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (!params.node_shared_operators || rank == 0)
+        update_cache_variables(params.eta);
+}
+
+/// @brief Read the pose, nucleation sites and external force of a body, without any nodes
+///
+///   @param[in] body_table toml table from pre-parsed config
+Body::Body(const toml::value &body_table) {
+    using namespace parse_util;
+
     if (body_table.contains("position"))
         position_ = convert_array<>(body_table.at("position").as_array());
 
@@ -174,10 +326,6 @@ Body::Body(const toml::value &body_table, const Params &params) {
 
     if (body_table.contains("external_force"))
         external_force_ = convert_array<>(body_table.at("external_force").as_array());
-
-    move(position_, orientation_);
-
-    update_cache_variables(params.eta);
 }
 
 /// @brief Check for collision with body and periphery.
@@ -212,6 +360,88 @@ bool SphericalBody::check_collision(const SphericalBody &body, double threshold)
     return (dr2 < pow(this->radius_ + body.radius_ + threshold, 2));
 }
 
+/// @brief Construct a multipole sphere from its body table. Reads 'radius', no precompute file
+///
+/// The nodes are the 12 vertices of an icosahedron on the body surface. With equal weights they integrate polynomials
+/// up to degree 5 exactly, which covers every moment of the body's own Stokeslet, rotlet and stresslet.
+///   @param[in] body_table toml table from pre-parsed config
+///   @param[in] params Pre-constructed Params object
+MultipoleSphericalBody::MultipoleSphericalBody(const toml::value &body_table, const Params &params)
+    : SphericalBody(body_table), eta_(params.eta) {
+    if (radius_ <= 0.0)
+        throw std::runtime_error("Multipole body requires a positive 'radius'");
+
+    const double phi = 0.5 * (1.0 + std::sqrt(5.0));
+    n_nodes_ = 12;
+    node_normals_ref_.resize(3, n_nodes_);
+    int i_node = 0;
+    for (double s1 : {-1.0, 1.0}) {
+        for (double s2 : {-1.0, 1.0}) {
+            node_normals_ref_.col(i_node++) = Eigen::Vector3d{0.0, s1, s2 * phi}.normalized();
+            node_normals_ref_.col(i_node++) = Eigen::Vector3d{s1, s2 * phi, 0.0}.normalized();
+            node_normals_ref_.col(i_node++) = Eigen::Vector3d{s2 * phi, 0.0, s1}.normalized();
+        }
+    }
+    node_positions_ref_ = radius_ * node_normals_ref_;
+    node_weights_ = Eigen::VectorXd::Constant(n_nodes_, 4.0 * M_PI * radius_ * radius_ / n_nodes_);
+    node_positions_ = node_positions_ref_;
+    node_normals_ = node_normals_ref_;
+
+    move(position_, orientation_);
+}
+
+/// @brief Surface moments of a velocity field sampled on the body nodes. @see MultipoleSphericalBody
+///
+/// @param[in] v_body [3 x 12] velocities at the body nodes
+/// @return [12] stresslet \f$5 \eta \oint (n u)^{\textrm{dev}} dS\f$ (xx, yy, zz, xy, xz, yz), mean velocity and
+/// half vorticity
+Eigen::Matrix<double, 12, 1> MultipoleSphericalBody::get_moments(MatrixRef &v_body) const {
+    Eigen::Matrix3d nu = Eigen::Matrix3d::Zero();
+    Eigen::Vector3d mean = Eigen::Vector3d::Zero();
+    Eigen::Vector3d n_cross_u = Eigen::Vector3d::Zero();
+    for (int i = 0; i < n_nodes_; ++i) {
+        const Eigen::Vector3d n = (node_positions_.col(i) - position_) / radius_;
+        const Eigen::Vector3d u = v_body.col(i);
+        nu += node_weights_[i] * n * u.transpose();
+        mean += node_weights_[i] * u;
+        n_cross_u += node_weights_[i] * n.cross(u);
+    }
+    Eigen::Matrix3d S = 2.5 * eta_ * (nu + nu.transpose());
+    S.diagonal().array() -= S.trace() / 3.0;
+
+    const double area = 4.0 * M_PI * radius_ * radius_;
+    Eigen::Matrix<double, 12, 1> moments;
+    moments << S(0, 0), S(1, 1), S(2, 2), S(0, 1), S(0, 2), S(1, 2), mean / area,
+        1.5 / radius_ * n_cross_u / area;
+    return moments;
+}
+
+/// @brief Symmetric stresslet from its packed (xx, yy, zz, xy, xz, yz) form
+Eigen::Matrix3d MultipoleSphericalBody::unpack_stresslet(VectorRef &s) {
+    Eigen::Matrix3d S;
+    S << s[0], s[3], s[4], s[3], s[1], s[5], s[4], s[5], s[2];
+    return S;
+}
+
+/// @brief Set the RHS_ to the moments of the velocity that does not depend on the solution
+///
+/// The rows are \f$ -M_S(u) = M_S(u_0) \f$ and \f$ U - M_U(u) = M_U(u_0) \f$ for the moments M of the flow u from the
+/// solution and the flow \f$u_0\f$ given here, so the moments of the total flow satisfy Faxen's laws.
+/// @param[in] v_on_body [3 x 12] velocity at the body nodes
+void MultipoleSphericalBody::update_RHS(MatrixRef &v_on_body) { RHS_ = get_moments(v_on_body); }
+
+/// @brief Apply this body's block of the matrix-free operator. @see update_RHS
+///
+/// @param[in] v_body [3 x 12] velocities at the body nodes from every source, this body's multipoles included
+/// @param[in] density unused, multipole bodies have no surface density
+/// @param[in] velocity [6] body velocity and angular velocity
+/// @return [12] body block of the operator applied to the solution
+Eigen::VectorXd MultipoleSphericalBody::matvec(MatrixRef &v_body, MatrixRef &density, VectorRef &velocity) const {
+    Eigen::VectorXd res = -get_moments(v_body);
+    res.tail(6) += velocity;
+    return res;
+}
+
 /// @brief Update the RHS for all bodies for given velocities
 ///
 /// @param[in] v_on_bodies [3 x n_local_body_nodes] matrix of velocities at the body nodes
@@ -280,48 +510,60 @@ Eigen::MatrixXd BodyContainer::get_local_node_normals() const {
     return node_normals;
 }
 
-/// @brief unpack linearized body solution/guess/whatever vector into two things more useful
+/// @brief unpack linearized body solution/guess/whatever vector into three things more useful
 ///
-/// All nodes get a copy of body_velocities, while only rank 0 gets the body_densities
+/// All nodes get a copy of body_velocities, while only rank 0 gets the body_densities and stresslets
 /// @param[in] x Linearized body state vector
 /// @return <[6 x n_bodies_global] vector of body velocities + angular velocities,
-/// [3 x n_body_nodes_local] vector of body "densities">
-std::pair<Eigen::MatrixXd, Eigen::MatrixXd> BodyContainer::unpack_solution_vector(VectorRef &x) const {
+/// [3 x n_body_nodes_local] vector of body "densities", zero on multipole bodies,
+/// [9 x n_bodies_local] vector of center stresslets, zero on surface bodies>
+std::tuple<Eigen::MatrixXd, Eigen::MatrixXd, Eigen::MatrixXd>
+BodyContainer::unpack_solution_vector(VectorRef &x) const {
     using Eigen::MatrixXd;
     const int n_bodies_global = get_global_count();
     MatrixXd body_velocities(6, n_bodies_global);
-    MatrixXd body_densities(3, get_local_node_count());
+    MatrixXd body_densities = MatrixXd::Zero(3, get_local_node_count());
+    MatrixXd body_stresslets = MatrixXd::Zero(9, get_local_count());
     if (world_rank_ == 0) {
         int offset = 0;
         int density_col = 0;
         for (int i = 0; i < n_bodies_global; ++i) {
-            for (int j = 0; j < bodies[i]->n_nodes_; ++j) {
-                body_densities.col(density_col) = x.segment(offset, 3);
-                density_col++;
-                offset += 3;
+            if (bodies[i]->is_multipole()) {
+                Eigen::Map<Eigen::Matrix3d>(body_stresslets.col(i).data()) =
+                    MultipoleSphericalBody::unpack_stresslet(x.segment(offset, 6));
+                offset += 6;
+                density_col += bodies[i]->n_nodes_;
+            } else {
+                for (int j = 0; j < bodies[i]->n_nodes_; ++j) {
+                    body_densities.col(density_col) = x.segment(offset, 3);
+                    density_col++;
+                    offset += 3;
+                }
             }
 
             body_velocities.col(i) = x.segment(offset, 6);
             offset += 6;
         }
     }
+    TRACE_SCOPE("MPI_Bcast body velocities", "mpi");
     MPI_Bcast(body_velocities.data(), 6 * n_bodies_global, MPI_DOUBLE, 0, MPI_COMM_WORLD);
-    return std::make_pair(body_velocities, body_densities);
+    return std::make_tuple(body_velocities, body_densities, body_stresslets);
 }
 
 /// @brief Calculate velocity at target coordinates due to the bodies
 /// @param[in] r_trg [3 x n_trg_local] Matrix of target coordinates to evaluate the velocity due to bodies at
 /// @param[in] densities [3 x n_nodes_local] Matrix of body node source strengths
+/// @param[in] stresslets [9 x n_bodies_local] Matrix of center stresslets of multipole bodies
 /// @param[in] forces_torques [6 x n_bodies] Matrix of body center-of-mass forces and torques
 /// @param[in] eta Fluid viscosity
 /// @return [3 x n_trg_local] Matrix of velocities due to bodies at target coordinates
-Eigen::MatrixXd BodyContainer::flow(MatrixRef &r_trg, MatrixRef &densities, MatrixRef &forces_torques,
-                                    double eta) const {
+Eigen::MatrixXd BodyContainer::flow(MatrixRef &r_trg, MatrixRef &densities, MatrixRef &stresslets,
+                                    MatrixRef &forces_torques, double eta) const {
+    TRACE_SCOPE("body flow", "flow");
     spdlog::debug("Started body flow");
     utils::LoggerRedirect redirect(std::cout);
     if (!bodies.size())
         return Eigen::MatrixXd::Zero(3, r_trg.cols());
-    const int n_nodes = get_local_node_count(); //< Distributed node counts for fmm calls
     const int n_trg = r_trg.cols();
     const Eigen::MatrixXd node_positions = get_local_node_positions(); //< Distributed node positions for fmm calls
     const Eigen::MatrixXd node_normals = get_local_node_normals();     //< Distributed node normals for fmm calls
@@ -329,14 +571,33 @@ Eigen::MatrixXd BodyContainer::flow(MatrixRef &r_trg, MatrixRef &densities, Matr
     const int n_bodies_global = get_global_count();
 
     // Section: Stresslet kernel
-    const Eigen::MatrixXd &r_dl = node_positions; //< "double layer" positions for stresslet kernel
-    Eigen::MatrixXd f_dl(9, n_nodes);             //< "double layer" "force" for stresslet kernel
+    // Surface bodies contribute their nodes, multipole bodies a single stresslet at their center
+    int n_dl = 0;
+    for (size_t i_body = 0; i_body < get_local_count(); ++i_body)
+        n_dl += bodies[i_body]->is_multipole() ? 1 : bodies[i_body]->n_nodes_;
+    Eigen::MatrixXd r_dl(3, n_dl); //< "double layer" positions for stresslet kernel
+    Eigen::MatrixXd f_dl(9, n_dl); //< "double layer" "force" for stresslet kernel
+
+    int node = 0;
+    int i_dl = 0;
+    for (size_t i_body = 0; i_body < get_local_count(); ++i_body) {
+        const auto &body = bodies[i_body];
+        if (body->is_multipole()) {
+            r_dl.col(i_dl) = body->position_;
+            f_dl.col(i_dl) = stresslets.col(i_body);
+            i_dl++;
+            node += body->n_nodes_;
+            continue;
+        }
 
-    // double layer density is 2 * outer product of normals with density
-    for (int node = 0; node < n_nodes; ++node)
-        for (int i = 0; i < 3; ++i)
-            for (int j = 0; j < 3; ++j)
-                f_dl(i * 3 + j, node) = 2.0 * node_normals(i, node) * densities(j, node);
+        // double layer density is 2 * outer product of normals with density
+        for (int j = 0; j < body->n_nodes_; ++j, ++node, ++i_dl) {
+            r_dl.col(i_dl) = node_positions.col(node);
+            for (int i = 0; i < 3; ++i)
+                for (int k = 0; k < 3; ++k)
+                    f_dl(i * 3 + k, i_dl) = 2.0 * node_normals(i, node) * densities(k, node);
+        }
+    }
 
     spdlog::debug("body_stresslet");
     Eigen::MatrixXd v_bdy2all =
@@ -372,38 +633,22 @@ Eigen::MatrixXd BodyContainer::flow(MatrixRef &r_trg, MatrixRef &densities, Matr
 /// @return [body_local_solution_size] vector 'y' in the formulation above
 Eigen::VectorXd BodyContainer::matvec(MatrixRef &v_bodies, MatrixRef &body_densities,
                                       MatrixRef &body_velocities) const {
-    using Eigen::Block;
-    using Eigen::MatrixXd;
     using Eigen::VectorXd;
     VectorXd res(get_local_solution_size());
     if (world_rank_ == 0) {
         int node_offset = 0;
+        int offset = 0;
 
         for (size_t i_body = 0; i_body < bodies.size(); ++i_body) {
             const auto &body = bodies[i_body];
-            VectorMap res_nodes(res.data() + node_offset + i_body * 6, body->n_nodes_ * 3);
-            VectorMap res_com(res.data() + node_offset + i_body * 6 + body->n_nodes_ * 3, 6);
-
+            CMatrixMap v(v_bodies.data() + node_offset, 3, body->n_nodes_);
             CMatrixMap d(body_densities.data() + node_offset, 3, body->n_nodes_);
             CVectorMap U(body_velocities.data() + 6 * i_body, 6);
 
-            VectorXd cx(3 * body->n_nodes_), cy(3 * body->n_nodes_), cz(3 * body->n_nodes_);
-            cx.setZero();
-            cy.setZero();
-            cz.setZero();
-            for (int i = 0; i < body->n_nodes_; ++i) {
-                cx.segment(i * 3, 3) += d(0, i) / body->node_weights_(i) * body->ex_.col(i);
-                cy.segment(i * 3, 3) += d(1, i) / body->node_weights_(i) * body->ey_.col(i);
-                cz.segment(i * 3, 3) += d(2, i) / body->node_weights_(i) * body->ez_.col(i);
-            }
-
-            VectorXd KU = body->K_ * U;
-            VectorXd KTLambda = body->K_.transpose() * CVectorMap(d.data(), 3 * body->n_nodes_);
-
-            res_nodes = -(cx + cy + cz) - KU + CVectorMap(v_bodies.data() + node_offset, body->n_nodes_ * 3);
-            res_com = -KTLambda + U;
+            res.segment(offset, body->get_solution_size()) = body->matvec(v, d, U);
 
             node_offset += 3 * body->n_nodes_;
+            offset += body->get_solution_size();
         }
     }
     return res;
@@ -418,8 +663,8 @@ Eigen::VectorXd BodyContainer::apply_preconditioner(VectorRef &x) const {
     if (world_rank_ == 0) {
         int offset = 0;
         for (const auto &b : bodies) {
-            const int blocksize = b->n_nodes_ * 3 + 6;
-            res.segment(offset, blocksize) = b->A_LU_.solve(x.segment(offset, blocksize));
+            const int blocksize = b->get_solution_size();
+            res.segment(offset, blocksize) = b->apply_preconditioner(x.segment(offset, blocksize));
             offset += blocksize;
         }
     }
@@ -433,6 +678,7 @@ Eigen::VectorXd BodyContainer::apply_preconditioner(VectorRef &x) const {
 BodyContainer::BodyContainer(toml::array &body_tables, Params &params) {
     MPI_Comm_size(MPI_COMM_WORLD, &world_size_);
     MPI_Comm_rank(MPI_COMM_WORLD, &world_rank_);
+    root_only_operators_ = params.node_shared_operators;
 
     // TODO: Make mult_order and max_pts passable fmm parameters
     {
@@ -443,6 +689,8 @@ BodyContainer::BodyContainer(toml::array &body_tables, Params &params) {
         oseen_kernel_ = std::unique_ptr<kernels::FMM<stkfmm::Stk3DFMM>>(new kernels::FMM<stkfmm::Stk3DFMM>(
             8, 2000, stkfmm::PAXIS::NONE, stkfmm::KERNEL::Stokes, kernels::stokes_vel_fmm));
         redirect.flush(spdlog::level::debug, "STKFMM");
+        stresslet_kernel_->set_sort_points(params.stkfmm.sort_points);
+        oseen_kernel_->set_sort_points(params.stkfmm.sort_points);
     }
 
     const int n_bodies_tot = body_tables.size();
@@ -450,7 +698,14 @@ BodyContainer::BodyContainer(toml::array &body_tables, Params &params) {
 
     for (int i_body = 0; i_body < n_bodies_tot; ++i_body) {
         toml::value &body_table = body_tables.at(i_body);
-        bodies.emplace_back(new SphericalBody(body_table, params));
+        const std::string representation = toml::find_or<std::string>(body_table, "representation", "surface");
+        if (representation == "multipole")
+            bodies.emplace_back(new MultipoleSphericalBody(body_table, params));
+        else if (representation == "surface")
+            bodies.emplace_back(new SphericalBody(body_table, params));
+        else
+            throw std::runtime_error("Unknown body representation '" + representation +
+                                     "'. Valid values are 'surface' and 'multipole'");
 
         auto &body = bodies.back();
         spdlog::info("Body {}: {} [ {}, {}, {} ]", i_body, body->node_weights_.size(), body->position_[0],
@@ -0,0 +1,170 @@
+#include <skelly_sim.hpp>
+
+#include <body.hpp>
+#include <coarse_correction.hpp>
+#include <fiber.hpp>
+#include <periphery.hpp>
+#include <system.hpp>
+#include <trace.hpp>
+
+#include <mpi.h>
+#include <omp.h>
+
+#include <spdlog/spdlog.h>
+
+/// @file
+/// @brief Implement CoarseCorrection, the optional second level of the System preconditioner
+
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+const std::string CoarseCorrection::mode_name[] = {"none", "additive", "multiplicative"};
+
+/// @brief Construct coarse correction from its configuration string
+/// @param[in] mode one of CoarseCorrection::mode_name
+CoarseCorrection::CoarseCorrection(const std::string &mode) {
+    for (int i = 0; i < 3; ++i)
+        if (mode == mode_name[i])
+            mode_ = static_cast<Mode>(i);
+
+    if (mode_name[mode_] != mode)
+        throw std::runtime_error("Unknown coarse_correction '" + mode +
+                                 "'. Valid values are 'none', 'additive', 'multiplicative'");
+}
+
+/// @brief Sum the x, y and z position blocks of one local fiber, i.e. apply \f$Z_i^T\f$
+/// @param[in] x [local_solution_size] vector
+/// @param[in] i_fib index of local fiber
+/// @return [3] restriction of x onto the rigid translation modes of the fiber
+Eigen::Vector3d CoarseCorrection::restrict_fiber(VectorRef &x, int i_fib) const {
+    const int np = fib_n_nodes_[i_fib];
+    const int offset = fib_offsets_[i_fib];
+    return {x.segment(offset + 0 * np, np).sum(), x.segment(offset + 1 * np, np).sum(),
+            x.segment(offset + 2 * np, np).sum()};
+}
+
+/// @brief Rebuild the coarse space and Galerkin operator for the current system state
+///
+/// Must be called after the fiber, body and shell operators are updated for the timestep, and before the solve.
+/// Costs one System::apply_matvec per body rigid mode and shell translation mode.
+void CoarseCorrection::update() {
+    if (mode_ == None)
+        return;
+
+    const FiberContainer &fc = *System::get_fiber_container();
+    const BodyContainer &bc = *System::get_body_container();
+    const Periphery &shell = *System::get_shell();
+    double st = omp_get_wtime();
+
+    const auto [fib_sol_size, shell_sol_size, body_sol_size] = System::get_local_solution_sizes();
+    const int sol_size = fib_sol_size + shell_sol_size + body_sol_size;
+    const int n_body_modes = 6 * bc.get_global_count();
+    const int n_shell_modes = shell.n_nodes_global_ ? 3 : 0;
+    n_global_ = n_body_modes + n_shell_modes;
+
+    // Global basis: unit rigid body velocity (zero density) for each body, then uniform shell density
+    Z_global_ = MatrixXd::Zero(sol_size, n_global_);
+    if (body_sol_size) {
+        int offset = fib_sol_size + shell_sol_size;
+        for (size_t i_body = 0; i_body < bc.get_global_count(); ++i_body) {
+            offset += bc.at(i_body).get_solution_size() - 6;
+            for (int k = 0; k < 6; ++k)
+                Z_global_(offset + k, 6 * i_body + k) = 1.0;
+            offset += 6;
+        }
+    }
+    for (int k = 0; k < n_shell_modes; ++k)
+        for (int i_node = 0; i_node < shell_sol_size / 3; ++i_node)
+            Z_global_(fib_sol_size + 3 * i_node + k, n_body_modes + k) = 1.0;
+
+    AZ_global_.resize(sol_size, n_global_);
+    for (int j = 0; j < n_global_; ++j)
+        AZ_global_.col(j) = System::apply_matvec(Z_global_.col(j));
+
+    if (n_global_) {
+        MatrixXd G = Z_global_.transpose() * AZ_global_;
+        TRACE_SCOPE("MPI_Allreduce coarse operator", "mpi");
+        MPI_Allreduce(MPI_IN_PLACE, G.data(), G.size(), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        G_LU_.compute(G);
+    }
+
+    // Fiber rigid translations produce no fiber force, so only the local fiber operator acts on them
+    const int n_fibers = fc.get_local_count();
+    fib_offsets_.resize(n_fibers);
+    fib_n_nodes_.resize(n_fibers);
+    AZ_fibers_.resize(n_fibers);
+    C_fibers_.resize(n_fibers);
+    D_LU_.resize(n_fibers);
+    int i_fib = 0;
+    int offset = 0;
+    for (const auto &fib : fc.fibers) {
+        const int np = fib.n_nodes_;
+        fib_offsets_[i_fib] = offset;
+        fib_n_nodes_[i_fib] = np;
+
+        MatrixXd &AZ = AZ_fibers_[i_fib];
+        AZ.resize(4 * np, 3);
+        for (int k = 0; k < 3; ++k)
+            AZ.col(k) = fib.A_.block(0, k * np, 4 * np, np).rowwise().sum();
+
+        MatrixXd D(3, 3);
+        for (int k = 0; k < 3; ++k)
+            for (int l = 0; l < 3; ++l)
+                D(l, k) = AZ.block(l * np, k, np, 1).sum();
+        D_LU_[i_fib].compute(D);
+
+        C_fibers_[i_fib].resize(3, n_global_);
+        for (int j = 0; j < n_global_; ++j)
+            C_fibers_[i_fib].col(j) = restrict_fiber(AZ_global_.col(j), i_fib);
+
+        offset += 4 * np;
+        i_fib++;
+    }
+
+    spdlog::info("Coarse correction updated with {} global modes in {} seconds", n_global_, omp_get_wtime() - st);
+}
+
+/// @brief Restrict a residual to the coarse space and solve the Galerkin system
+///
+/// \f[ c = (Z^T A Z)^{-1} Z^T r \f]
+/// @param[in] r [local_solution_size] residual vector
+/// @return coarse solution
+CoarseCorrection::coarse_vec_t CoarseCorrection::solve(VectorRef &r) const {
+    coarse_vec_t c;
+    c.global = VectorXd::Zero(n_global_);
+    if (n_global_) {
+        VectorXd r_global = Z_global_.transpose() * r;
+        TRACE_SCOPE("MPI_Allreduce coarse residual", "mpi");
+        MPI_Allreduce(MPI_IN_PLACE, r_global.data(), n_global_, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        c.global = G_LU_.solve(r_global);
+    }
+
+    c.fibers.resize(3 * fib_offsets_.size());
+    for (size_t i_fib = 0; i_fib < fib_offsets_.size(); ++i_fib) {
+        Eigen::Vector3d r_fib = restrict_fiber(r, i_fib) - C_fibers_[i_fib] * c.global;
+        c.fibers.segment(3 * i_fib, 3) = D_LU_[i_fib].solve(r_fib);
+    }
+
+    return c;
+}
+
+/// @brief Interpolate a coarse vector back to the full solution space, \f$ Z c \f$
+Eigen::VectorXd CoarseCorrection::prolong(const coarse_vec_t &c) const {
+    VectorXd y = Z_global_ * c.global;
+    for (size_t i_fib = 0; i_fib < fib_offsets_.size(); ++i_fib) {
+        const int np = fib_n_nodes_[i_fib];
+        for (int k = 0; k < 3; ++k)
+            y.segment(fib_offsets_[i_fib] + k * np, np).array() += c.fibers(3 * i_fib + k);
+    }
+    return y;
+}
+
+/// @brief Apply the full operator to a prolonged coarse vector, \f$ A Z c \f$, without any matvecs
+Eigen::VectorXd CoarseCorrection::apply_galerkin(const coarse_vec_t &c) const {
+    VectorXd y = AZ_global_ * c.global;
+    for (size_t i_fib = 0; i_fib < fib_offsets_.size(); ++i_fib) {
+        const int np = fib_n_nodes_[i_fib];
+        y.segment(fib_offsets_[i_fib], 4 * np) += AZ_fibers_[i_fib] * c.fibers.segment(3 * i_fib, 3);
+    }
+    return y;
+}
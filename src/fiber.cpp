@@ -1,14 +1,19 @@
 #include <skelly_sim.hpp>
 
 #include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <numeric>
 #include <unordered_map>
 
 #include <fiber.hpp>
 #include <kernels.hpp>
 #include <periphery.hpp>
+#include <screened_stokeslet.hpp>
+#include <trace.hpp>
 #include <utils.hpp>
 
+#include <omp.h>
 #include <spdlog/spdlog.h>
 #include <toml.hpp>
 
@@ -57,7 +62,9 @@ void FiberContainer::update_boundary_conditions(Periphery &shell, bool periphery
         fib.bc_minus_ = fib.attached_to_body()
                             ? std::make_pair(Fiber::BC::Velocity, Fiber::BC::AngularVelocity) // Clamped to body
                             : std::make_pair(Fiber::BC::Force, Fiber::BC::Torque);            // Free
-        fib.near_periphery = shell.check_collision(fib.x_, threshold);
+        if (!fib.geometry_is_current() || fib.geometry_.near_periphery < 0)
+            fib.geometry_.near_periphery = shell.check_collision(fib.x_, threshold);
+        fib.near_periphery = fib.geometry_.near_periphery;
         fib.bc_plus_ = (fib.near_periphery && periphery_binding_flag)
                            ? std::make_pair(Fiber::BC::Velocity, Fiber::BC::Torque) // Hinge at cortex
                            : std::make_pair(Fiber::BC::Force, Fiber::BC::Torque);   // Free
@@ -182,11 +189,45 @@ void Fiber::update_linear_operator(double dt, double eta) {
     A_TT += (c_0_ + c_1_) * (xss_x.pow(2) + xss_y.pow(2) + xss_z.pow(2)).matrix().asDiagonal();
 }
 
+/// @brief Set the time derivative coefficients for the next step, and keep the current positions for the one after
+///
+/// With \f$ \omega = dt / dt_{prev} \f$, variable-step BDF2 approximates \f$ dX/dt \f$ at \f$ t^{n+1} \f$ by
+/// \f[ (\beta X^{n+1} - X_{hist}) / dt, \quad \beta = \frac{1 + 2\omega}{1 + \omega}, \quad
+/// X_{hist} = (1 + \omega) X^n - \frac{\omega^2}{1 + \omega} X^{n-1} \f]
+/// Everything the step treats explicitly (the operator's \f$ X_s, X_{ss} \f$, boundary rows, forces and flows) is
+/// then evaluated at the extrapolated positions \f$ X^* = (1 + \omega) X^n - \omega X^{n-1} \f$, which are
+/// second order accurate at \f$ t^{n+1} \f$, rather than lagged at \f$ X^n \f$, which would be first order.
+/// Without usable history (first step, new, resampled or growing fiber) this falls back to backward Euler.
+///
+/// Updates: Fiber::beta_tstep_, Fiber::x_hist_, Fiber::x_prev_, Fiber::x_ (to \f$ X^* \f$ for BDF2)
+/// @param[in] omega ratio of this step to the last accepted one, 0 for a first order step
+/// @param[in] keep_history keep Fiber::x_ as Fiber::x_prev_ for the next step
+void Fiber::update_time_history(double omega, bool keep_history) {
+    MatrixXd x_star;
+    if (omega > 0.0 && x_prev_.cols() == n_nodes_ && length_ == length_prev_ && v_growth_ == 0.0) {
+        beta_tstep_ = (1.0 + 2.0 * omega) / (1.0 + omega);
+        x_hist_ = (1.0 + omega) * x_ - (omega * omega / (1.0 + omega)) * x_prev_;
+        x_star = (1.0 + omega) * x_ - omega * x_prev_;
+    } else {
+        beta_tstep_ = 1.0;
+        x_hist_.resize(3, 0);
+    }
+
+    if (keep_history)
+        x_prev_ = x_;
+    else
+        x_prev_.resize(3, 0);
+
+    if (x_star.size())
+        x_ = std::move(x_star);
+}
+
 /// @brief Compute the 'right-hand-side' for the linear system with upsampling
 ///
 /// \f[ A * (X^{n+1}, T^{n+1}) = \textrm{RHS} \f]
 /// where
-/// \f[ \textrm{RHS} = (X^n / dt + \textrm{flow} + \textrm{Mobility} * \textrm{force\_external}, ...) \f]
+/// \f[ \textrm{RHS} = (X_{hist} / dt + \textrm{flow} + \textrm{Mobility} * \textrm{force\_external}, ...) \f]
+/// and \f$ X_{hist} \f$ is \f$ X^n \f$ for backward Euler. @see Fiber::get_history_positions
 /// Updates: Fiber::RHS_
 /// @param[in] dt timestep size
 /// @param[in] flow [ 3 x n_nodes_ ] matrix of flow field sampled at the fiber points
@@ -199,9 +240,10 @@ void Fiber::update_RHS(double dt, MatrixRef &flow, MatrixRef &f_external) {
     MatrixXd D_3 = mats.D_3_0 * std::pow(2.0 / length_, 3);
     MatrixXd D_4 = mats.D_4_0 * std::pow(2.0 / length_, 4);
 
-    ArrayXd x_x = x_.block(0, 0, 1, np).transpose().array();
-    ArrayXd x_y = x_.block(1, 0, 1, np).transpose().array();
-    ArrayXd x_z = x_.block(2, 0, 1, np).transpose().array();
+    const MatrixXd &x_rhs = get_history_positions();
+    ArrayXd x_x = x_rhs.block(0, 0, 1, np).transpose().array();
+    ArrayXd x_y = x_rhs.block(1, 0, 1, np).transpose().array();
+    ArrayXd x_z = x_rhs.block(2, 0, 1, np).transpose().array();
 
     ArrayXd xs_x = xs_.block(0, 0, 1, np).transpose().array();
     ArrayXd xs_y = xs_.block(1, 0, 1, np).transpose().array();
@@ -295,7 +337,69 @@ void Fiber::update_force_operator() {
     }
 }
 
-void Fiber::update_preconditioner() { A_LU_.compute(A_); }
+/// @brief Compute LU decomposition of Fiber::A_ for the preconditioner and remember the state it was built from
+///
+/// Updates: Fiber::A_LU_ or Fiber::A_LU_f_, Fiber::factorized_
+/// @param[in] dt timestep size A_ was built with
+/// @param[in] single_precision factorize in float, for the inner solves of Solver::solve_mixed_precision
+void Fiber::update_preconditioner(double dt, bool single_precision) {
+    if (single_precision) {
+        A_LU_f_.compute(A_.cast<float>());
+        A_LU_ = Eigen::FullPivLU<Eigen::MatrixXd>();
+    } else {
+        A_LU_.compute(A_);
+        A_LU_f_ = Eigen::FullPivLU<Eigen::MatrixXf>();
+    }
+    factorized_.single_precision = single_precision;
+    factorized_.xs = xs_;
+    factorized_.xss = xss_;
+    factorized_.length = length_;
+    factorized_.dt = dt / beta_tstep_;
+    factorized_.bc_minus = bc_minus_;
+    factorized_.bc_plus = bc_plus_;
+}
+
+/// @brief Check if the position-only caches were built for the current Fiber::x_ and Fiber::length_prev_
+bool Fiber::geometry_is_current() const {
+    return geometry_.x.cols() == x_.cols() && geometry_.length_prev == length_prev_ && geometry_.x == x_;
+}
+
+/// @brief Move the position-only caches from the same fiber in a rejected step attempt
+///
+/// Used when a step is retried from the same starting geometry. Fiber::geometry_is_current still decides if they
+/// are used, since the retry's dynamic instability can change Fiber::length_prev_.
+/// @param[in, out] rejected fiber after the rejected attempt. Its caches are left empty
+void Fiber::take_geometry_caches(Fiber &rejected) {
+    xs_ = std::move(rejected.xs_);
+    xss_ = std::move(rejected.xss_);
+    xsss_ = std::move(rejected.xsss_);
+    xssss_ = std::move(rejected.xssss_);
+    stokeslet_ = std::move(rejected.stokeslet_);
+    geometry_ = std::move(rejected.geometry_);
+    rejected.geometry_.x.resize(3, 0);
+}
+
+/// @brief Check if the last factorization of A_ is close enough to the current operator to be reused
+///
+/// The true operator still enters through the matvec, so a lagged factorization only affects iteration counts.
+/// Boundary condition or resolution changes always invalidate the factorization.
+/// @param[in] dt current timestep size
+/// @param[in] geometry_tol max allowed change in the tangent vectors and in length-scaled curvature vectors
+/// @param[in] length_tol max allowed relative change in fiber length
+/// @param[in] dt_tol max allowed relative change in timestep size
+/// @return true if the lagged factorization can be reused
+bool Fiber::preconditioner_is_current(double dt, double geometry_tol, double length_tol, double dt_tol) const {
+    if (factorized_.xs.cols() != n_nodes_ || factorized_.bc_minus != bc_minus_ || factorized_.bc_plus != bc_plus_)
+        return false;
+    if (fabs(length_ - factorized_.length) > length_tol * length_)
+        return false;
+    // A_ depends on the timestep only through beta_tstep_ / dt
+    if (fabs(dt / beta_tstep_ - factorized_.dt) > dt_tol * dt / beta_tstep_)
+        return false;
+    const double dxs = (xs_ - factorized_.xs).colwise().norm().maxCoeff();
+    const double dxss = length_ * (xss_ - factorized_.xss).colwise().norm().maxCoeff();
+    return std::max(dxs, dxss) <= geometry_tol;
+}
 
 void Fiber::apply_bc_rectangular(double dt, MatrixRef &v_on_fiber, MatrixRef &f_on_fiber) {
     const int np = n_nodes_;
@@ -305,6 +409,8 @@ void Fiber::apply_bc_rectangular(double dt, MatrixRef &v_on_fiber, MatrixRef &f_
     MatrixXd D_3 = mats.D_3_0.transpose() * std::pow(2.0 / length_, 3);
     MatrixXd D_4 = mats.D_4_0.transpose() * std::pow(2.0 / length_, 4);
 
+    const MatrixXd &x_rhs = get_history_positions();
+
     // Downsample A, leaving last 14 rows untouched
     A_.block(0, 0, 4 * np - 14, 4 * np) = mats.P_downsample_bc * A_;
 
@@ -327,7 +433,7 @@ void Fiber::apply_bc_rectangular(double dt, MatrixRef &v_on_fiber, MatrixRef &f_
 
         // FIXME: Tag fibers with BC_minus_vec[2]
         Vector3d BC_minus_vec_0({0.0, 0.0, 0.0});
-        B_RHS.segment(0, 3) = x_.col(0) / dt + BC_minus_vec_0;
+        B_RHS.segment(0, 3) = x_rhs.col(0) / dt + BC_minus_vec_0;
         B_RHS(3) = 0.0;
 
         if (v_on_fiber.size())
@@ -373,7 +479,9 @@ void Fiber::apply_bc_rectangular(double dt, MatrixRef &v_on_fiber, MatrixRef &f_
 
         // FIXME: Tag fibers with BC_minus_vec[2]
         Vector3d BC_minus_vec_1({0.0, 0.0, 0.0});
-        B_RHS.segment(4, 3) = xs_.col(0) / dt + BC_minus_vec_1;
+        // Backward Euler keeps xs_, which is taken at length_prev_. A history implies length_ == length_prev_
+        const Vector3d xs_rhs = x_hist_.cols() == np ? Vector3d(x_rhs * D_1.row(0).transpose()) : Vector3d(xs_.col(0));
+        B_RHS.segment(4, 3) = xs_rhs / dt + BC_minus_vec_1;
 
         break;
     }
@@ -407,7 +515,7 @@ void Fiber::apply_bc_rectangular(double dt, MatrixRef &v_on_fiber, MatrixRef &f_
 
         // FIXME: Tag fibers with BC_plus_vec[2]
         Vector3d BC_plus_vec_0{0.0, 0.0, 0.0};
-        B_RHS.segment(7, 3) = x_.col(endc) / dt + BC_plus_vec_0;
+        B_RHS.segment(7, 3) = x_rhs.col(endc) / dt + BC_plus_vec_0;
         B_RHS(10) = 0.0;
 
         if (v_on_fiber.size())
@@ -495,14 +603,55 @@ MatrixXd barycentric_matrix(ArrayRef &x, ArrayRef &y) {
     return P;
 }
 
+/// @brief Resample fiber to a new resolution, interpolating Fiber::x_ with barycentric_matrix
+///
+/// Derived quantities (derivatives, operators, preconditioner) are invalidated and must be recomputed by the
+/// usual cache updates before the next solve.
+/// Updates: Fiber::n_nodes_, Fiber::x_, Fiber::tension_, and resizes the derivative arrays
+/// @param[in] n_nodes_new new number of nodes. Must be a key of Fiber::matrices_
+void Fiber::resample(int n_nodes_new) {
+    if (n_nodes_new == n_nodes_)
+        return;
+
+    const MatrixXd P = barycentric_matrix(matrices_.at(n_nodes_).alpha, matrices_.at(n_nodes_new).alpha);
+    x_ = x_ * P.transpose();
+    if (tension_.size() == n_nodes_)
+        tension_ = P * tension_;
+    n_nodes_ = n_nodes_new;
+    xs_.resize(3, n_nodes_);
+    xss_.resize(3, n_nodes_);
+    xsss_.resize(3, n_nodes_);
+    xssss_.resize(3, n_nodes_);
+}
+
+/// @brief Maximum curvature along the fiber, from the second derivative of the current positions
+///
+/// Taken on accepted positions, which the solve parametrized by Fiber::length_, so like the spacing criterion of
+/// FiberContainer::update_resolution this uses Fiber::length_. Fiber::update_derivatives uses Fiber::length_prev_
+/// only because it runs after dynamic instability has already changed Fiber::length_ for the coming step.
+/// @return \f$ \max_i |{\bf x}_{ss}(s_i)| \f$
+double Fiber::max_curvature() const {
+    const MatrixXd xss = std::pow(2.0 / length_, 2) * x_ * matrices_.at(n_nodes_).D_2_0;
+    return xss.colwise().norm().maxCoeff();
+}
+
 /// @brief Helper function to initialize Fiber::matrices_
 /// @tparam n_nodes_finite_diff Number of neighboring points to use in finite difference approximation
+/// @param[out] buffer storage the returned arrays map into. Collective over the node communicator if node_shared
+/// @param[in] node_shared place the arrays once per compute node in an MPI-3 shared memory window
 /// @return map of Fiber::fib_mat_t initialized for various numbers of points, where the key will be Fiber::n_nodes_
-std::unordered_map<int, Fiber::fib_mat_t> compute_matrices(int n_nodes_finite_diff) {
-    std::unordered_map<int, Fiber::fib_mat_t> res;
-
-    for (auto n_nodes : {8, 16, 24, 32, 48, 64, 96, 128}) {
-        auto &mats = res[n_nodes];
+std::unordered_map<int, Fiber::fib_mat_t> compute_matrices(int n_nodes_finite_diff, utils::SharedBuffer &buffer,
+                                                           bool node_shared) {
+    struct arrays_t {
+        ArrayXd alpha, alpha_roots, alpha_tension, weights_0;
+        MatrixXd D_1_0, D_2_0, D_3_0, D_4_0, P_X, P_T, P_downsample_bc;
+    };
+    std::vector<arrays_t> arrays(Fiber::supported_n_nodes_.size());
+    size_t total_size = 0;
+
+    for (size_t i = 0; i < arrays.size(); ++i) {
+        const int n_nodes = Fiber::supported_n_nodes_[i];
+        auto &mats = arrays[i];
         mats.alpha = ArrayXd::LinSpaced(n_nodes, -1.0, 1.0);
 
         auto n_nodes_roots = n_nodes - 4;
@@ -535,17 +684,75 @@ std::unordered_map<int, Fiber::fib_mat_t> compute_matrices(int n_nodes_finite_di
         mats.P_downsample_bc.block(1 * (np - 4), 1 * np, np - 4, np) = mats.P_X;
         mats.P_downsample_bc.block(2 * (np - 4), 2 * np, np - 4, np) = mats.P_X;
         mats.P_downsample_bc.block(3 * (np - 4), 3 * np, np - 2, np) = mats.P_T;
+
+        total_size += mats.alpha.size() + mats.alpha_roots.size() + mats.alpha_tension.size() +
+                      mats.weights_0.size() + mats.D_1_0.size() + mats.D_2_0.size() + mats.D_3_0.size() +
+                      mats.D_4_0.size() + mats.P_X.size() + mats.P_T.size() + mats.P_downsample_bc.size();
+    }
+
+    // Pack everything into one buffer and point the maps into it. Maps are rebound with placement new, as Eigen
+    // documents for changing the array of a Map
+    buffer = utils::SharedBuffer(total_size, node_shared);
+    const bool write = buffer.is_writer();
+    double *ptr = buffer.data();
+    auto place_array = [&ptr, write](Eigen::Map<const ArrayXd> &dst, const ArrayXd &src) {
+        if (write)
+            std::copy(src.data(), src.data() + src.size(), ptr);
+        new (&dst) Eigen::Map<const ArrayXd>(ptr, src.size());
+        ptr += src.size();
+    };
+    auto place_matrix = [&ptr, write](Eigen::Map<const MatrixXd> &dst, const MatrixXd &src) {
+        if (write)
+            std::copy(src.data(), src.data() + src.size(), ptr);
+        new (&dst) Eigen::Map<const MatrixXd>(ptr, src.rows(), src.cols());
+        ptr += src.size();
+    };
+
+    std::unordered_map<int, Fiber::fib_mat_t> res;
+    for (size_t i = 0; i < arrays.size(); ++i) {
+        const auto &src = arrays[i];
+        auto &mats = res[Fiber::supported_n_nodes_[i]];
+        place_array(mats.alpha, src.alpha);
+        place_array(mats.alpha_roots, src.alpha_roots);
+        place_array(mats.alpha_tension, src.alpha_tension);
+        place_array(mats.weights_0, src.weights_0);
+        place_matrix(mats.D_1_0, src.D_1_0);
+        place_matrix(mats.D_2_0, src.D_2_0);
+        place_matrix(mats.D_3_0, src.D_3_0);
+        place_matrix(mats.D_4_0, src.D_4_0);
+        place_matrix(mats.P_X, src.P_X);
+        place_matrix(mats.P_T, src.P_T);
+        place_matrix(mats.P_downsample_bc, src.P_downsample_bc);
     }
+    buffer.sync();
     return res;
 }
 
+const std::vector<int> Fiber::supported_n_nodes_ = {8, 16, 24, 32, 48, 64, 96, 128};
 // FIXME: Make this an input parameter
-const std::unordered_map<int, Fiber::fib_mat_t> Fiber::matrices_ = compute_matrices(4);
+utils::SharedBuffer Fiber::matrices_buffer_;
+std::unordered_map<int, Fiber::fib_mat_t> Fiber::matrices_ = compute_matrices(4, Fiber::matrices_buffer_, false);
+
+/// @brief Move Fiber::matrices_ into node shared memory, one copy per compute node. Collective over MPI_COMM_WORLD.
+///
+/// The private matrices are built during static initialization, before MPI exists, so they are replaced here.
+/// @see Params::node_shared_operators
+void Fiber::share_matrices() {
+    utils::SharedBuffer buffer;
+    auto matrices = compute_matrices(4, buffer, true);
+    matrices_ = std::move(matrices);
+    matrices_buffer_ = std::move(buffer);
+}
+
+FiberContainer::preconditioner_stats_t FiberContainer::preconditioner_stats_;
 
 int FiberContainer::get_global_count() const {
+    if (global_count_ >= 0)
+        return global_count_;
     const int local_fib_count = get_local_count();
     int global_fib_count;
 
+    TRACE_SCOPE("MPI_Allreduce fiber count", "mpi");
     MPI_Allreduce(&local_fib_count, &global_fib_count, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
     return global_fib_count;
 }
@@ -554,10 +761,112 @@ int FiberContainer::get_global_total_fib_nodes() const {
     const int local_fib_nodes = get_local_node_count();
     int global_fib_nodes;
 
+    TRACE_SCOPE("MPI_Allreduce fiber node count", "mpi");
     MPI_Allreduce(&local_fib_nodes, &global_fib_nodes, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
     return global_fib_nodes;
 }
 
+/// @brief Per-fiber constant parameters, in the order they're serialized
+/// @return [4 * n_fibers] bending_rigidity, penalty_param, force_scale, epsilon columns
+std::vector<double> FiberContainer::get_constant_params() const {
+    const size_t n_fibers = fibers.size();
+    std::vector<double> params(4 * n_fibers);
+    size_t i_fib = 0;
+    for (const auto &fib : fibers) {
+        params[0 * n_fibers + i_fib] = fib.bending_rigidity_;
+        params[1 * n_fibers + i_fib] = fib.penalty_param_;
+        params[2 * n_fibers + i_fib] = fib.force_scale_;
+        params[3 * n_fibers + i_fib] = fib.epsilon_;
+        i_fib++;
+    }
+    return params;
+}
+
+/// @brief Take the constant parameters of each fiber from the corresponding fiber of another container
+///
+/// Used on resume, when the last trajectory frame didn't include them.
+void FiberContainer::copy_constant_params(const FiberContainer &src) {
+    if (src.fibers.size() != fibers.size())
+        throw std::runtime_error("Fiber count mismatch copying constant fiber parameters");
+
+    auto src_fib = src.fibers.begin();
+    for (auto &fib : fibers) {
+        fib.bending_rigidity_ = src_fib->bending_rigidity_;
+        fib.penalty_param_ = src_fib->penalty_param_;
+        fib.force_scale_ = src_fib->force_scale_;
+        fib.epsilon_ = src_fib->epsilon_;
+        src_fib++;
+    }
+}
+
+/// @brief Deserialize from the columnar layout of FiberContainer::msgpack_pack, or from the older list of per-fiber
+/// maps ([[fiber, fiber, ...]])
+///
+/// Only the serialized state is restored. Fibers still need Fiber::init before use.
+void FiberContainer::msgpack_unpack(msgpack::object o) {
+    fibers.clear();
+    if (o.type == msgpack::type::ARRAY) {
+        if (o.via.array.size != 1)
+            throw msgpack::type_error();
+        o.via.array.ptr[0].convert(fibers);
+        with_constant_params_ = true;
+        return;
+    }
+    if (o.type != msgpack::type::MAP)
+        throw msgpack::type_error();
+
+    auto find = [&o](const std::string &key) -> const msgpack::object * {
+        for (uint32_t i = 0; i < o.via.map.size; ++i)
+            if (o.via.map.ptr[i].key.as<std::string>() == key)
+                return &o.via.map.ptr[i].val;
+        return nullptr;
+    };
+    auto column = [&find](const std::string &key, size_t n) {
+        std::vector<double> res(n);
+        const msgpack::object *obj = find(key);
+        if (!obj || obj->type != msgpack::type::BIN || obj->via.bin.size != n * sizeof(double))
+            throw std::runtime_error("Invalid '" + key + "' column in fiber frame");
+        std::memcpy(res.data(), obj->via.bin.ptr, n * sizeof(double));
+        return res;
+    };
+
+    const msgpack::object *n_nodes_obj = find("n_nodes");
+    const msgpack::object *binding_site_obj = find("binding_site");
+    if (!n_nodes_obj || !binding_site_obj)
+        throw std::runtime_error("Missing 'n_nodes' or 'binding_site' column in fiber frame");
+    const auto n_nodes = n_nodes_obj->as<std::vector<int>>();
+    const auto binding_site = binding_site_obj->as<std::vector<int>>();
+    const size_t n_fibers = n_nodes.size();
+    if (binding_site.size() != 2 * n_fibers)
+        throw std::runtime_error("Invalid 'binding_site' column in fiber frame");
+
+    const std::vector<double> length = column("length", n_fibers);
+    const std::vector<double> x = column("x", 3 * std::accumulate(n_nodes.begin(), n_nodes.end(), size_t(0)));
+
+    with_constant_params_ = find("bending_rigidity") != nullptr;
+    std::vector<std::vector<double>> params;
+    if (with_constant_params_)
+        for (const auto &key : {"bending_rigidity", "penalty_param", "force_scale", "epsilon"})
+            params.push_back(column(key, n_fibers));
+
+    size_t offset = 0;
+    for (size_t i_fib = 0; i_fib < n_fibers; ++i_fib) {
+        Fiber fib;
+        fib.n_nodes_ = n_nodes[i_fib];
+        fib.length_ = length[i_fib];
+        fib.binding_site_ = {binding_site[2 * i_fib], binding_site[2 * i_fib + 1]};
+        fib.x_ = Eigen::Map<const MatrixXd>(x.data() + offset, 3, fib.n_nodes_);
+        offset += 3 * fib.n_nodes_;
+        if (with_constant_params_) {
+            fib.bending_rigidity_ = params[0][i_fib];
+            fib.penalty_param_ = params[1][i_fib];
+            fib.force_scale_ = params[2][i_fib];
+            fib.epsilon_ = params[3][i_fib];
+        }
+        fibers.push_back(fib);
+    }
+}
+
 void FiberContainer::update_derivatives() {
     for (auto &fib : fibers)
         fib.update_derivatives();
@@ -574,11 +883,25 @@ void FiberContainer::update_linear_operators(double dt, double eta) {
         fib.update_linear_operator(dt, eta);
 }
 
-VectorXd FiberContainer::apply_preconditioner(VectorRef &x_all) const {
+/// @brief Apply the block diagonal fiber preconditioner
+///
+/// Single precision factorizations are only made for the inner solves of Solver::solve_mixed_precision, so asking for
+/// double precision from one is an error rather than a silent loss of accuracy.
+/// @param[in] x_all [local_solution_size] vector to precondition
+/// @param[in] single_precision apply the single precision factorizations, Fiber::A_LU_f_
+/// @return [local_solution_size] preconditioned vector
+VectorXd FiberContainer::apply_preconditioner(VectorRef &x_all, bool single_precision) const {
     VectorXd y(x_all.size());
     size_t offset = 0;
     for (auto &fib : fibers) {
-        y.segment(offset, 4 * fib.n_nodes_) = fib.A_LU_.solve(x_all.segment(offset, 4 * fib.n_nodes_));
+        if (fib.factorized_.single_precision != single_precision)
+            throw std::runtime_error(std::string("Fiber preconditioner is not factorized in ") +
+                                     (single_precision ? "single" : "double") + " precision");
+        if (single_precision)
+            y.segment(offset, 4 * fib.n_nodes_) =
+                fib.A_LU_f_.solve(x_all.segment(offset, 4 * fib.n_nodes_).cast<float>()).cast<double>();
+        else
+            y.segment(offset, 4 * fib.n_nodes_) = fib.A_LU_.solve(x_all.segment(offset, 4 * fib.n_nodes_));
         offset += 4 * fib.n_nodes_;
     }
     return y;
@@ -660,7 +983,19 @@ MatrixXd FiberContainer::get_local_node_positions() const {
     return r;
 }
 
-MatrixXd FiberContainer::flow(MatrixRef &fib_forces, MatrixRef &r_trg_external, double eta) const {
+/// @brief Flow from the fiber forces on the fiber nodes (excluding each fiber's self interaction) and external targets
+///
+/// With a cutoff set in Params::fiber_screening, only sources within the cutoff of a target contribute, summed
+/// directly by FiberContainer::screened_kernel_ instead of the FMM.
+/// @param[in] fib_forces [ 3 x n_fiber_nodes ] force on each local fiber node
+/// @param[in] r_trg_external [ 3 x n_trg_external ] other target positions
+/// @param[in] eta viscosity
+/// @param[in] full_fmm use the FMM even with a cutoff set, e.g. to measure the screening error. Collective
+/// @param[in] single_precision use FiberContainer::stokeslet_kernel_low_ if present. Collective
+/// @return [ 3 x (n_fiber_nodes + n_trg_external) ] velocities at the fiber nodes followed by the external targets
+MatrixXd FiberContainer::flow(MatrixRef &fib_forces, MatrixRef &r_trg_external, double eta, bool full_fmm,
+                              bool single_precision) const {
+    TRACE_SCOPE("fiber flow", "flow");
     spdlog::debug("Starting fiber flow");
     const size_t n_src = fib_forces.cols();
     const size_t n_trg_external = r_trg_external.cols();
@@ -688,9 +1023,27 @@ MatrixXd FiberContainer::flow(MatrixRef &fib_forces, MatrixRef &r_trg_external,
     r_trg.block(0, 0, 3, n_src) = r_src;
     if (n_trg_external)
         r_trg.block(0, n_src, 3, n_trg_external) = r_trg_external;
+
+    if (screened_kernel_ && !full_fmm) {
+        // Group sources by fiber, unique across ranks, so self interactions are skipped rather than subtracted
+        std::vector<long> src_group(n_src);
+        std::vector<long> trg_group(n_src + n_trg_external, -1);
+        offset = 0;
+        long group = long(world_rank_) << 32;
+        for (const auto &fib : fibers) {
+            std::fill(src_group.begin() + offset, src_group.begin() + offset + fib.n_nodes_, group++);
+            offset += fib.n_nodes_;
+        }
+        std::copy(src_group.begin(), src_group.end(), trg_group.begin());
+
+        spdlog::debug("Finished fiber flow");
+        return (*screened_kernel_)(r_src, weighted_forces, src_group, r_trg, trg_group, eta);
+    }
+
     MatrixXd r_dl_dummy, f_dl_dummy;
     utils::LoggerRedirect redirect(std::cout);
-    MatrixXd vel = (*stokeslet_kernel_)(r_src, r_dl_dummy, r_trg, weighted_forces, f_dl_dummy) / eta;
+    auto &kernel = single_precision && stokeslet_kernel_low_ ? *stokeslet_kernel_low_ : *stokeslet_kernel_;
+    MatrixXd vel = kernel(r_src, r_dl_dummy, r_trg, weighted_forces, f_dl_dummy) / eta;
     redirect.flush(spdlog::level::debug, "STKFMM");
 
     // Subtract self term
@@ -734,13 +1087,51 @@ MatrixXd FiberContainer::apply_fiber_force(VectorRef &x_all) const {
     return fw;
 }
 
-void FiberContainer::update_cache_variables(double dt, double eta) {
+/// @brief Update the cache variables of every fiber for a step of size dt
+///
+/// Derivatives and stokeslets only depend on position, so they are kept if already built for the current geometry,
+/// e.g. when a rejected step is retried with a smaller dt. @see take_geometry_caches
+/// @return number of fibers whose position-only caches were rebuilt
+int FiberContainer::update_cache_variables(double dt, double eta) {
+    TRACE_SCOPE("fiber cache", "step");
+    int n_rebuilt = 0;
     for (auto &fib : fibers) {
-        fib.update_derivatives();
-        fib.update_stokeslet(eta);
+        if (!fib.geometry_is_current()) {
+            fib.update_derivatives();
+            fib.update_stokeslet(eta);
+            fib.geometry_.x = fib.x_;
+            fib.geometry_.length_prev = fib.length_prev_;
+            fib.geometry_.near_periphery = -1;
+            n_rebuilt++;
+        }
         fib.update_linear_operator(dt, eta);
         fib.update_force_operator();
     }
+    return n_rebuilt;
+}
+
+/// @brief Move position-only caches from the fibers of a rejected step attempt into this (restored) container
+///
+/// Dynamic instability only removes fibers and appends new ones, so surviving fibers keep their order and are
+/// matched by the geometry their caches were built for.
+/// @param[in, out] rejected container after the rejected attempt
+void FiberContainer::take_geometry_caches(FiberContainer &rejected) {
+    auto src = rejected.fibers.begin();
+    for (auto &fib : fibers) {
+        auto match = std::find_if(src, rejected.fibers.end(), [&fib](const Fiber &f) {
+            return f.geometry_.x.cols() == fib.x_.cols() && f.geometry_.x == fib.x_;
+        });
+        if (match == rejected.fibers.end())
+            continue;
+        fib.take_geometry_caches(*match);
+        src = std::next(match);
+    }
+}
+
+/// @brief Set every fiber's time derivative coefficients for the next step. @see Fiber::update_time_history
+void FiberContainer::update_time_history(double omega, bool keep_history) {
+    for (auto &fib : fibers)
+        fib.update_time_history(omega, keep_history);
 }
 
 void FiberContainer::update_RHS(double dt, MatrixRef &v_on_fibers, MatrixRef &f_on_fibers) {
@@ -752,15 +1143,96 @@ void FiberContainer::update_RHS(double dt, MatrixRef &v_on_fibers, MatrixRef &f_
     }
 }
 
-void FiberContainer::apply_bc_rectangular(double dt, MatrixRef &v_on_fibers, MatrixRef &f_on_fibers) {
+/// @brief Apply every fiber's boundary conditions and refactorize the preconditioners that are out of date
+/// @param[in] factorize false to skip the factorizations, when the step does not use the preconditioner
+void FiberContainer::apply_bc_rectangular(double dt, MatrixRef &v_on_fibers, MatrixRef &f_on_fibers, bool factorize) {
+    TRACE_SCOPE("fiber bc and factorization", "step");
+    factorize = factorize && refactor_policy_.factorize;
+    const bool lagged =
+        refactor_policy_.geometry_tol > 0.0 || refactor_policy_.length_tol > 0.0 || refactor_policy_.dt_tol > 0.0;
+    long n_factorized = 0;
+    double factor_time = 0.0;
+
     size_t offset = 0;
     for (auto &fib : fibers) {
         fib.apply_bc_rectangular(dt, v_on_fibers.block(0, offset, 3, fib.n_nodes_),
                                  f_on_fibers.block(0, offset, 3, fib.n_nodes_));
         // FIXME: preconditioner update probably shouldn't be here. think of how to organize it with other cache
-        fib.update_preconditioner();
+        const bool refactor =
+            factorize &&
+            (!lagged || fib.factorized_.single_precision != refactor_policy_.single_precision ||
+             !fib.preconditioner_is_current(dt, refactor_policy_.geometry_tol, refactor_policy_.length_tol,
+                                            refactor_policy_.dt_tol));
+        if (refactor) {
+            double st = omp_get_wtime();
+            fib.update_preconditioner(dt, refactor_policy_.single_precision);
+            factor_time += omp_get_wtime() - st;
+            n_factorized++;
+        }
         offset += fib.n_nodes_;
     }
+
+    auto &stats = preconditioner_stats_;
+    stats.n_factorized += n_factorized;
+    if (factorize)
+        stats.n_reused += fibers.size() - n_factorized;
+    stats.factor_time += factor_time;
+    if (lagged)
+        spdlog::debug("Refactorized {} of {} fiber preconditioners in {} seconds", n_factorized, fibers.size(),
+                      factor_time);
+}
+
+/// @brief Pick the smallest supported resolution that resolves a fiber of the given length and curvature
+///
+/// A resolution is accepted if the node spacing \f$h = L / (n - 1)\f$ satisfies both
+/// \f$h \le \textrm{scale} \cdot \textrm{max\_spacing}\f$ and \f$h \kappa \le \textrm{scale} \cdot \textrm{max\_angle}\f$.
+/// @param[in] length fiber length
+/// @param[in] curvature maximum curvature along the fiber
+/// @param[in] scale factor applied to both tolerances
+/// @return n_nodes within [min_nodes, max_nodes], or the largest allowed if none satisfy the criteria
+int FiberContainer::select_n_nodes(double length, double curvature, double scale) const {
+    const auto &policy = resolution_policy_;
+    int n_selected = -1;
+    for (int n_nodes : Fiber::supported_n_nodes_) {
+        if (n_nodes < policy.min_nodes || n_nodes > policy.max_nodes)
+            continue;
+        n_selected = n_nodes;
+        const double h = length / (n_nodes - 1);
+        if (h <= scale * policy.max_spacing && h * curvature <= scale * policy.max_angle)
+            break;
+    }
+    if (n_selected < 0)
+        throw std::runtime_error("No supported fiber resolution between min_nodes and max_nodes");
+    return n_selected;
+}
+
+/// @brief Refine or coarsen each fiber to the resolution its current geometry requires
+///
+/// Refinement happens as soon as the criteria are violated, while coarsening requires the criteria to hold with
+/// tolerances scaled by coarsen_margin, so fibers near a threshold don't flip-flop between resolutions.
+/// Should only be called on accepted states, before the cache variables for the next step are computed.
+/// @return number of local fibers that were resampled
+int FiberContainer::update_resolution() {
+    if (!resolution_policy_.adaptive)
+        return 0;
+
+    int n_resampled = 0;
+    for (auto &fib : fibers) {
+        const double curvature = fib.max_curvature();
+        int n_nodes_new = select_n_nodes(fib.length_, curvature);
+        if (n_nodes_new <= fib.n_nodes_)
+            n_nodes_new =
+                std::min(fib.n_nodes_, select_n_nodes(fib.length_, curvature, resolution_policy_.coarsen_margin));
+
+        if (n_nodes_new != fib.n_nodes_) {
+            spdlog::get("SkellySim global")
+                ->debug("Resampling fiber {} from {} to {} nodes (length {}, curvature {})", (void *)&fib,
+                        fib.n_nodes_, n_nodes_new, fib.length_, curvature);
+            fib.resample(n_nodes_new);
+            n_resampled++;
+        }
+    }
+    return n_resampled;
 }
 
 FiberContainer::FiberContainer(toml::array &fiber_tables, Params &params) {
@@ -774,9 +1246,33 @@ FiberContainer::FiberContainer(toml::array &fiber_tables, Params &params) {
         const int max_pts = params.stkfmm.fiber_stokeslet_max_points;
         stokeslet_kernel_ = std::unique_ptr<kernels::FMM<stkfmm::Stk3DFMM>>(new kernels::FMM<stkfmm::Stk3DFMM>(
             mult_order, max_pts, stkfmm::PAXIS::NONE, stkfmm::KERNEL::Stokes, kernels::stokes_vel_fmm));
+        stokeslet_kernel_->set_sort_points(params.stkfmm.sort_points);
+        if (params.mixed_precision.enabled) {
+            stokeslet_kernel_low_ = std::make_shared<kernels::FMM<stkfmm::Stk3DFMM>>(
+                params.mixed_precision.multipole_order, max_pts, stkfmm::PAXIS::NONE, stkfmm::KERNEL::Stokes,
+                kernels::stokes_vel_fmm);
+            stokeslet_kernel_low_->set_sort_points(params.stkfmm.sort_points);
+        }
         redirect.flush(spdlog::level::debug, "STKFMM");
     }
 
+    if (params.fiber_screening.cutoff > 0.0)
+        screened_kernel_ =
+            std::make_shared<ScreenedStokeslet>(params.fiber_screening.cutoff, params.fiber_screening.taper);
+
+    refactor_policy_.geometry_tol = params.preconditioner.fiber_refactor_geometry_tol;
+    refactor_policy_.length_tol = params.preconditioner.fiber_refactor_length_tol;
+    refactor_policy_.dt_tol = params.preconditioner.fiber_refactor_dt_tol;
+    refactor_policy_.single_precision = params.mixed_precision.enabled;
+    refactor_policy_.factorize = params.preconditioner.ifpack2_type.empty();
+
+    resolution_policy_.adaptive = params.fiber_resolution.adaptive;
+    resolution_policy_.min_nodes = params.fiber_resolution.min_nodes;
+    resolution_policy_.max_nodes = params.fiber_resolution.max_nodes;
+    resolution_policy_.max_spacing = params.fiber_resolution.max_spacing;
+    resolution_policy_.max_angle = params.fiber_resolution.max_angle;
+    resolution_policy_.coarsen_margin = params.fiber_resolution.coarsen_margin;
+
     const int n_fibs_tot = fiber_tables.size();
     const int n_fibs_extra = n_fibs_tot % world_size_;
     spdlog::info("Reading in {} fibers.", n_fibs_tot);
@@ -788,11 +1284,28 @@ FiberContainer::FiberContainer(toml::array &fiber_tables, Params &params) {
             displs[i]++;
     }
 
-    for (int i_fib = 0; i_fib < n_fibs_tot; ++i_fib) {
+    // Optionally distribute fibers in Morton order of their centroids, so each rank gets a compact region and
+    // neighboring fibers are adjacent in the container. Every rank computes the same order.
+    std::vector<int> fiber_order(n_fibs_tot);
+    std::iota(fiber_order.begin(), fiber_order.end(), 0);
+    if (params.fiber_ordering == "morton") {
+        MatrixXd centroids(3, n_fibs_tot);
+        for (int i_fib = 0; i_fib < n_fibs_tot; ++i_fib) {
+            std::vector<double> x = toml::find<std::vector<double>>(fiber_tables.at(i_fib), "x");
+            centroids.col(i_fib) = Eigen::Map<MatrixXd>(x.data(), 3, x.size() / 3).rowwise().mean();
+        }
+        fiber_order = utils::morton_order(centroids);
+    } else if (params.fiber_ordering != "input") {
+        throw std::runtime_error("Unknown fiber_ordering '" + params.fiber_ordering +
+                                 "'. Valid values are 'input', 'morton'");
+    }
+
+    for (int i_fib_sorted = 0; i_fib_sorted < n_fibs_tot; ++i_fib_sorted) {
         const int i_fib_low = displs[world_rank_];
         const int i_fib_high = displs[world_rank_ + 1];
 
-        if (i_fib >= i_fib_low && i_fib < i_fib_high) {
+        if (i_fib_sorted >= i_fib_low && i_fib_sorted < i_fib_high) {
+            const int i_fib = fiber_order[i_fib_sorted];
             toml::value &fiber_table = fiber_tables.at(i_fib);
             fibers.emplace_back(fiber_table, params.eta);
 
@@ -122,7 +122,7 @@ Eigen::MatrixXd kernels::oseen_tensor_direct(MatrixRef &r_src, MatrixRef &r_trg,
 /// @param[in] eta viscosity of fluid
 /// @param[in] reg regularization term
 /// @param[in] epsilon_distance threshold distance, below which source-target distances will be regularized
-/// @return [3 x n_trg] rotlet at target given source points
+/// @return [3 x n_trg] rotlet velocity at the targets, summed over all sources
 Eigen::MatrixXd kernels::rotlet(MatrixRef &r_src, MatrixRef &r_trg, MatrixRef &density, double eta, double reg,
                                 double epsilon_distance) {
     using Eigen::MatrixXd;
@@ -151,9 +151,9 @@ Eigen::MatrixXd kernels::rotlet(MatrixRef &r_src, MatrixRef &r_trg, MatrixRef &d
             double Myz = fr * dx;
             double Mzx = fr * dy;
             double Mzy = -fr * dx;
-            u(0, i_trg) = Mxy * density(1, i_src) + Mxz * density(2, i_src);
-            u(1, i_trg) = Myx * density(0, i_src) + Myz * density(2, i_src);
-            u(2, i_trg) = Mzx * density(0, i_src) + Mzy * density(1, i_src);
+            u(0, i_trg) += Mxy * density(1, i_src) + Mxz * density(2, i_src);
+            u(1, i_trg) += Myx * density(0, i_src) + Myz * density(2, i_src);
+            u(2, i_trg) += Mzx * density(0, i_src) + Mzy * density(1, i_src);
         }
     }
     u *= factor;
@@ -1,5 +1,9 @@
 #include <params.hpp>
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
 #include <mpi.h>
 
 Params::Params(toml::value &pt) {
@@ -16,6 +20,11 @@ Params::Params(toml::value &pt) {
     dt_write = toml::find_or(pt, "dt_write", 0.25);
     seed = toml::find_or(pt, "seed", 1);
     periphery_binding_flag = toml::find_or(pt, "periphery_binding_flag", false);
+    body_refresh_interval = toml::find_or(pt, "body_refresh_interval", 1);
+    node_shared_operators = toml::find_or(pt, "node_shared_operators", false);
+    shell_node_ordering = toml::find_or(pt, "shell_node_ordering", "index");
+    fiber_ordering = toml::find_or(pt, "fiber_ordering", "input");
+    time_scheme = toml::find_or(pt, "time_scheme", "bdf1");
 
     if (pt.contains("dynamic_instability")) {
         const auto &di = pt.at("dynamic_instability");
@@ -53,6 +62,141 @@ Params::Params(toml::value &pt) {
             toml::find_or(s, "periphery_stresslet_multipole_order", stkfmm.periphery_stresslet_multipole_order);
         stkfmm.periphery_stresslet_max_points =
             toml::find_or(s, "periphery_stresslet_max_points", stkfmm.periphery_stresslet_max_points);
+        stkfmm.sort_points = toml::find_or(s, "sort_points", stkfmm.sort_points);
+    }
+
+    if (pt.contains("preconditioner")) {
+        const auto p = pt.at("preconditioner");
+        preconditioner.coarse_correction =
+            toml::find_or(p, "coarse_correction", preconditioner.coarse_correction);
+        preconditioner.fiber_refactor_geometry_tol =
+            toml::find_or(p, "fiber_refactor_geometry_tol", preconditioner.fiber_refactor_geometry_tol);
+        preconditioner.fiber_refactor_length_tol =
+            toml::find_or(p, "fiber_refactor_length_tol", preconditioner.fiber_refactor_length_tol);
+        preconditioner.fiber_refactor_dt_tol =
+            toml::find_or(p, "fiber_refactor_dt_tol", preconditioner.fiber_refactor_dt_tol);
+        preconditioner.ifpack2_type = toml::find_or(p, "ifpack2_type", preconditioner.ifpack2_type);
+        if (p.contains("ifpack2_parameters"))
+            preconditioner.ifpack2_parameters = p.at("ifpack2_parameters");
+    }
+
+    if (pt.contains("krylov")) {
+        const auto k = pt.at("krylov");
+        krylov.method = toml::find_or(k, "method", krylov.method);
+        krylov.orthogonalization = toml::find_or(k, "orthogonalization", krylov.orthogonalization);
+        krylov.restart = toml::find_or(k, "restart", krylov.restart);
+        krylov.step_size = toml::find_or(k, "step_size", krylov.step_size);
+    }
+    {
+        // Orthogonalizations each method accepts, default first
+        const std::vector<std::string> belos_orthos = {"ICGS", "IMGS", "DGKS"};
+        const std::vector<std::string> tpetra_orthos = {"CGS2", "CholQR", "CholQR2"};
+        const std::map<std::string, std::vector<std::string>> methods = {
+            {"GMRES", belos_orthos},
+            {"PSEUDOBLOCK GMRES", belos_orthos},
+            {"BLOCK GMRES", belos_orthos},
+            {"TPETRA GMRES SINGLE REDUCE", tpetra_orthos},
+            {"TPETRA GMRES PIPELINE", tpetra_orthos},
+            {"TPETRA GMRES S-STEP", tpetra_orthos},
+        };
+        auto join = [](const std::vector<std::string> &names) {
+            std::string res;
+            for (const auto &name : names)
+                res += (res.empty() ? "'" : ", '") + name + "'";
+            return res;
+        };
+
+        const auto method = methods.find(krylov.method);
+        if (method == methods.end()) {
+            std::vector<std::string> names;
+            for (const auto &[name, orthos] : methods)
+                names.push_back(name);
+            throw std::runtime_error("Unknown krylov.method '" + krylov.method + "'. Valid values are " + join(names));
+        }
+        const auto &orthos = method->second;
+        if (krylov.orthogonalization.empty())
+            krylov.orthogonalization = orthos.front();
+        else if (std::find(orthos.begin(), orthos.end(), krylov.orthogonalization) == orthos.end())
+            throw std::runtime_error("krylov.orthogonalization '" + krylov.orthogonalization +
+                                     "' is not supported by '" + krylov.method + "'. Valid values are " +
+                                     join(orthos));
+        if (krylov.restart < 1 || krylov.step_size < 1)
+            throw std::runtime_error("krylov.restart and krylov.step_size must be positive");
+    }
+
+    if (pt.contains("direct_solve")) {
+        const auto d = pt.at("direct_solve");
+        direct_solve.max_size = toml::find_or(d, "max_size", direct_solve.max_size);
+    }
+
+    if (pt.contains("mixed_precision")) {
+        const auto m = pt.at("mixed_precision");
+        mixed_precision.enabled = toml::find_or(m, "enabled", mixed_precision.enabled);
+        mixed_precision.inner_tol = toml::find_or(m, "inner_tol", mixed_precision.inner_tol);
+        mixed_precision.max_refinements = toml::find_or(m, "max_refinements", mixed_precision.max_refinements);
+        mixed_precision.restart = toml::find_or(m, "restart", mixed_precision.restart);
+        mixed_precision.max_inner_iterations =
+            toml::find_or(m, "max_inner_iterations", mixed_precision.max_inner_iterations);
+        mixed_precision.multipole_order = toml::find_or(m, "multipole_order", mixed_precision.multipole_order);
+    }
+
+    if (pt.contains("imex")) {
+        const auto im = pt.at("imex");
+        imex.enabled = toml::find_or(im, "enabled", imex.enabled);
+        imex.fallback_tol = toml::find_or(im, "fallback_tol", imex.fallback_tol);
+        imex.fallback = toml::find_or(im, "fallback", imex.fallback);
+    }
+
+    if (pt.contains("fiber_screening")) {
+        const auto f = pt.at("fiber_screening");
+        fiber_screening.cutoff = toml::find_or(f, "cutoff", fiber_screening.cutoff);
+        fiber_screening.taper = toml::find_or(f, "taper", fiber_screening.taper);
+        fiber_screening.error_check_interval =
+            toml::find_or(f, "error_check_interval", fiber_screening.error_check_interval);
+    }
+
+    if (pt.contains("fiber_resolution")) {
+        const auto r = pt.at("fiber_resolution");
+        fiber_resolution.adaptive = toml::find_or(r, "adaptive", fiber_resolution.adaptive);
+        fiber_resolution.min_nodes = toml::find_or(r, "min_nodes", fiber_resolution.min_nodes);
+        fiber_resolution.max_nodes = toml::find_or(r, "max_nodes", fiber_resolution.max_nodes);
+        fiber_resolution.max_spacing = toml::find_or(r, "max_spacing", fiber_resolution.max_spacing);
+        fiber_resolution.max_angle = toml::find_or(r, "max_angle", fiber_resolution.max_angle);
+        fiber_resolution.coarsen_margin = toml::find_or(r, "coarsen_margin", fiber_resolution.coarsen_margin);
+    }
+
+    if (pt.contains("trajectory")) {
+        const auto t = pt.at("trajectory");
+        trajectory.segment_frames = toml::find_or(t, "segment_frames", trajectory.segment_frames);
+        trajectory.segment_bytes = toml::find_or(t, "segment_bytes", trajectory.segment_bytes);
+    }
+
+    if (pt.contains("checkpoint")) {
+        const auto c = pt.at("checkpoint");
+        checkpoint.file = toml::find_or(c, "file", checkpoint.file);
+        checkpoint.interval = toml::find_or(c, "interval", checkpoint.interval);
+        checkpoint.walltime = toml::find_or(c, "walltime", checkpoint.walltime);
+        checkpoint.on_signal = toml::find_or(c, "on_signal", checkpoint.on_signal);
+    }
+
+    if (pt.contains("telemetry")) {
+        const auto t = pt.at("telemetry");
+        telemetry.enabled = toml::find_or(t, "enabled", telemetry.enabled);
+        telemetry.name = toml::find_or(t, "name", telemetry.name);
+        telemetry.capacity = toml::find_or(t, "capacity", telemetry.capacity);
+        telemetry.rss_interval = toml::find_or(t, "rss_interval", telemetry.rss_interval);
+        // skelly_top reads at most capacity - 1 records, so a consistent snapshot needs at least two slots
+        if (telemetry.capacity < 2)
+            throw std::runtime_error("telemetry.capacity must be at least 2");
+        if (telemetry.rss_interval < 1)
+            throw std::runtime_error("telemetry.rss_interval must be at least 1");
+    }
+
+    if (pt.contains("trace")) {
+        const auto t = pt.at("trace");
+        trace.enabled = toml::find_or(t, "enabled", trace.enabled);
+        trace.file = toml::find_or(t, "file", trace.file);
+        trace.max_events = toml::find_or(t, "max_events", trace.max_events);
     }
 
     shell_precompute_file = toml::find_or(pt, "shell_precompute_file", "");
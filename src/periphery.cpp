@@ -2,41 +2,62 @@
 #include <cnpy.hpp>
 #include <kernels.hpp>
 #include <periphery.hpp>
+#include <trace.hpp>
 #include <utils.hpp>
 
 #include <mpi.h>
 
 #include <spdlog/spdlog.h>
 
-Eigen::VectorXd Periphery::apply_preconditioner(VectorRef &x_local) const {
-    if (!n_nodes_global_)
-        return Eigen::VectorXd();
+/// @brief Gather the shell density of all ranks
+/// @param[in] x_local [3 * n_nodes_local] density on this rank
+/// @return [3 * n_nodes_global_] density of all nodes
+Eigen::VectorXd Periphery::gather_density(VectorRef &x_local) const {
     assert(x_local.size() == get_local_solution_size());
     Eigen::VectorXd x_shell(3 * n_nodes_global_);
+    TRACE_SCOPE("MPI_Allgatherv shell", "mpi");
     MPI_Allgatherv(x_local.data(), node_counts_[world_rank_], MPI_DOUBLE, x_shell.data(), node_counts_.data(),
                    node_displs_.data(), MPI_DOUBLE, MPI_COMM_WORLD);
+    return x_shell;
+}
+
+/// @param[in] x_local [local_solution_size] vector to precondition
+/// @param[in] single_precision apply Periphery::M_inv_f_ if present
+/// @return [local_solution_size] preconditioned vector
+Eigen::VectorXd Periphery::apply_preconditioner(VectorRef &x_local, bool single_precision) const {
+    if (!n_nodes_global_)
+        return Eigen::VectorXd();
+    const Eigen::VectorXd x_shell = gather_density(x_local);
+    if (single_precision && M_inv_f_.size())
+        return (M_inv_f_ * x_shell.cast<float>()).cast<double>();
     return M_inv_ * x_shell;
 }
 
-Eigen::VectorXd Periphery::matvec(VectorRef &x_local, MatrixRef &v_local) const {
+/// @param[in] x_local [local_solution_size] shell density
+/// @param[in] v_local [3 x n_nodes_local] flow on the local shell nodes
+/// @param[in] single_precision apply Periphery::stresslet_plus_complementary_f_ if present
+/// @return [local_solution_size] shell rows of the system operator
+Eigen::VectorXd Periphery::matvec(VectorRef &x_local, MatrixRef &v_local, bool single_precision) const {
     if (!n_nodes_global_)
         return Eigen::VectorXd();
-    assert(x_local.size() == get_local_solution_size());
     assert(v_local.size() == get_local_solution_size());
-    Eigen::VectorXd x_shell(3 * n_nodes_global_);
-    MPI_Allgatherv(x_local.data(), node_counts_[world_rank_], MPI_DOUBLE, x_shell.data(), node_counts_.data(),
-                   node_displs_.data(), MPI_DOUBLE, MPI_COMM_WORLD);
+    const Eigen::VectorXd x_shell = gather_density(x_local);
+    if (single_precision && stresslet_plus_complementary_f_.size())
+        return (stresslet_plus_complementary_f_ * x_shell.cast<float>()).cast<double>() +
+               CVectorMap(v_local.data(), v_local.size());
     return stresslet_plus_complementary_ * x_shell + CVectorMap(v_local.data(), v_local.size());
 }
 
-Eigen::MatrixXd Periphery::flow(MatrixRef &r_trg, MatrixRef &density, double eta) const {
+Eigen::MatrixXd Periphery::flow(MatrixRef &r_trg, MatrixRef &density, double eta, bool single_precision) const {
     // Calculate velocity at target coordinates due to the periphery.
     // Input:
     //    const r_trg [3xn_trg_local]: Target coordinates
     //    const density [3*n_nodes_local]: Strength of node sources
     //    eta: Fluid viscosity
+    //    single_precision: use stresslet_kernel_low_ if present
     // Output:
     //    vel [3xn_trg_local]: velocity at target coordinates
+    TRACE_SCOPE("shell flow", "flow");
     spdlog::debug("Started shell flow");
     if (!n_nodes_global_)
         return Eigen::MatrixXd::Zero(3, r_trg.cols());
@@ -54,7 +75,8 @@ Eigen::MatrixXd Periphery::flow(MatrixRef &r_trg, MatrixRef &density, double eta
                 f_dl(i * 3 + j, node) = 2.0 * node_normal_(i, node) * density_reshaped(j, node);
 
     Eigen::MatrixXd r_sl, f_sl; // dummy SL positions/values
-    Eigen::MatrixXd pvel = (*stresslet_kernel_)(r_sl, node_pos_, r_trg, f_sl, f_dl);
+    auto &kernel = single_precision && stresslet_kernel_low_ ? *stresslet_kernel_low_ : *stresslet_kernel_;
+    Eigen::MatrixXd pvel = kernel(r_sl, node_pos_, r_trg, f_sl, f_dl);
     Eigen::MatrixXd vel = pvel.block(1, 0, 3, n_trg) / eta;
     redirect.flush(spdlog::level::debug, "STKFMM");
 
@@ -84,7 +106,148 @@ bool SphericalPeriphery::check_collision(const MatrixRef &point_cloud, double th
     return false;
 }
 
-Periphery::Periphery(const std::string &precompute_file, const toml::value &body_table, const Params &params) {
+/// @brief Build a spherical periphery on the nodes of a vector spherical harmonic grid, with fast operators
+///
+/// Reads `radius` and `sh_order` from the periphery table. Nodes sit at node_scale_factor * radius, as in the
+/// precompute script. No precompute file is needed.
+SphericalPeriphery::SphericalPeriphery(const toml::value &periphery_table, const Params &params) : Periphery(params) {
+    radius_ = toml::find_or<double>(periphery_table, "radius", 0.0);
+    const int order = toml::find_or<int>(periphery_table, "sh_order", 0);
+    if (order < 1)
+        throw std::runtime_error("Spherical harmonic periphery requires sh_order >= 1");
+    sht_ = VectorSHT(order);
+
+    const double node_radius = node_scale_factor * radius_;
+    const int n_nodes = sht_.get_n_nodes();
+    const Eigen::MatrixXd nodes = node_radius * sht_.get_nodes();
+    grid_weights_ = node_radius * node_radius * sht_.get_weights();
+
+    node_order_ = Eigen::VectorXi::LinSpaced(n_nodes, 0, n_nodes - 1);
+    if (params.shell_node_ordering == "morton") {
+        const std::vector<int> morton = utils::morton_order(nodes);
+        node_order_ = Eigen::Map<const Eigen::VectorXi>(morton.data(), n_nodes);
+    } else if (params.shell_node_ordering != "index") {
+        throw std::runtime_error("Unknown shell_node_ordering '" + params.shell_node_ordering +
+                                 "'. Valid values are 'index', 'morton'");
+    }
+
+    partition_nodes(n_nodes);
+    const int n_nodes_local = quad_counts_[world_rank_];
+    node_pos_.resize(3, n_nodes_local);
+    node_normal_.resize(3, n_nodes_local);
+    quadrature_weights_.resize(n_nodes_local);
+    for (int i = 0; i < n_nodes_local; ++i) {
+        const int i_grid = node_order_[quad_displs_[world_rank_] + i];
+        node_pos_.col(i) = nodes.col(i_grid);
+        node_normal_.col(i) = -nodes.col(i_grid) / node_radius;
+        quadrature_weights_[i] = grid_weights_[i_grid];
+    }
+    n_nodes_global_ = n_nodes;
+
+    const double eta = params.eta;
+    poloidal_.resize(order + 1);
+    poloidal_inv_.resize(order + 1);
+    toroidal_.resize(order + 1);
+    for (int l = 0; l <= order; ++l) {
+        poloidal_[l] = get_poloidal_block(l, eta, node_radius);
+        toroidal_[l] = get_toroidal_eigenvalue(l, eta);
+        if (std::abs(toroidal_[l]) < 1E-12 || std::abs(poloidal_[l].determinant()) < 1E-12)
+            throw std::runtime_error("Periphery operator is singular at degree " + std::to_string(l) +
+                                     " for eta = " + std::to_string(eta));
+        poloidal_inv_[l] = poloidal_[l].inverse();
+    }
+    high_degree_ = -1.0 + 0.5 / eta;
+    if (std::abs(high_degree_) < 1E-12)
+        throw std::runtime_error("Periphery operator is singular beyond the resolved degrees for eta = " +
+                                 std::to_string(eta));
+
+    spdlog::info("Initialized spherical harmonic periphery: order {}, {} nodes", order, n_nodes);
+}
+
+/// @brief Radial/poloidal block of the shell operator at degree l
+///
+/// With \f$D = (2l - 1)(2l + 1)(2l + 3)\f$, the stresslet part scales with 1 / eta, the jump term does not, and the
+/// complementary kernel only acts on the l = 0 radial mode.
+/// @param[in] l degree
+/// @param[in] eta viscosity
+/// @param[in] node_radius radius of the node sphere
+/// @return map from (radial, poloidal) density coefficients to velocity coefficients. At l = 0, where there is no
+/// poloidal mode, that part is the identity
+Eigen::Matrix2d SphericalPeriphery::get_poloidal_block(int l, double eta, double node_radius) {
+    const double D = (2.0 * l - 1.0) * (2.0 * l + 1.0) * (2.0 * l + 3.0);
+    Eigen::Matrix2d block;
+    block << -1.0 + (0.5 - 1.5 / D) / eta, -3.0 * l * (l + 1.0) / (D * eta), -3.0 / (D * eta),
+        -1.0 + (0.5 - 4.5 / D) / eta;
+    if (l == 0) {
+        block(0, 0) += 4.0 * M_PI * node_radius * node_radius;
+        block(0, 1) = block(1, 0) = 0.0;
+        block(1, 1) = 1.0;
+    }
+    return block;
+}
+
+/// @brief Toroidal eigenvalue of the shell operator at degree l
+/// @param[in] l degree
+/// @param[in] eta viscosity
+double SphericalPeriphery::get_toroidal_eigenvalue(int l, double eta) {
+    return -1.0 + (l - 1.0) / ((2.0 * l + 1.0) * eta);
+}
+
+/// @brief Apply the shell operator, or its inverse, with vector spherical harmonic transforms
+///
+/// The operator acts on the weighted density \f$u = w \phi\f$. With analysis A and synthesis S on the grid, it is
+/// \f$ S B A + \lambda_\infty (I - S A) \f$ for the block diagonal B. Since A S = I, its inverse is
+/// \f$ S B^{-1} A + \lambda_\infty^{-1} (I - S A) \f$.
+/// @param[in] x_local [3 * n_nodes_local] weighted density (operator) or velocity (inverse) on this rank
+/// @param[in] inverse apply the inverse operator
+/// @return [3 * n_nodes_local] result on this rank
+Eigen::VectorXd SphericalPeriphery::apply_spectral(VectorRef &x_local, bool inverse) const {
+    TRACE_SCOPE("shell spectral", "precond");
+    const Eigen::VectorXd x_shell = gather_density(x_local);
+    Eigen::MatrixXd f(3, n_nodes_global_);
+    for (int i = 0; i < n_nodes_global_; ++i)
+        f.col(node_order_[i]) = x_shell.segment(3 * i, 3);
+    if (!inverse)
+        f.array().rowwise() /= grid_weights_.transpose().array();
+
+    VectorSHT::coeffs_t coeffs = sht_.analyze(f);
+    Eigen::MatrixXd res = f - sht_.synthesize(coeffs);
+    res *= inverse ? 1.0 / high_degree_ : high_degree_;
+
+    const auto &blocks = inverse ? poloidal_inv_ : poloidal_;
+    for (int l = 0; l <= sht_.get_order(); ++l) {
+        for (int m = 0; m <= l; ++m) {
+            const std::complex<double> a = coeffs.a(l, m), b = coeffs.b(l, m);
+            coeffs.a(l, m) = blocks[l](0, 0) * a + blocks[l](0, 1) * b;
+            coeffs.b(l, m) = blocks[l](1, 0) * a + blocks[l](1, 1) * b;
+            coeffs.c(l, m) *= inverse ? 1.0 / toroidal_[l] : toroidal_[l];
+        }
+    }
+    res += sht_.synthesize(coeffs);
+    if (inverse)
+        res.array().rowwise() *= grid_weights_.transpose().array();
+
+    const int n_nodes_local = quad_counts_[world_rank_];
+    Eigen::VectorXd res_local(3 * n_nodes_local);
+    for (int i = 0; i < n_nodes_local; ++i)
+        res_local.segment(3 * i, 3) = res.col(node_order_[quad_displs_[world_rank_] + i]);
+    return res_local;
+}
+
+Eigen::VectorXd SphericalPeriphery::apply_preconditioner(VectorRef &x_local, bool single_precision) const {
+    if (sht_.get_order() < 0)
+        return Periphery::apply_preconditioner(x_local, single_precision);
+    return apply_spectral(x_local, true);
+}
+
+Eigen::VectorXd SphericalPeriphery::matvec(VectorRef &x_local, MatrixRef &v_local, bool single_precision) const {
+    if (sht_.get_order() < 0)
+        return Periphery::matvec(x_local, v_local, single_precision);
+    return apply_spectral(x_local, false) + CVectorMap(v_local.data(), v_local.size());
+}
+
+/// @brief Set up the stresslet FMM and MPI layout, without any nodes
+Periphery::Periphery(const Params &params) {
     {
         using namespace kernels;
         using namespace stkfmm;
@@ -93,12 +256,40 @@ Periphery::Periphery(const std::string &precompute_file, const toml::value &body
         utils::LoggerRedirect redirect(std::cout);
         stresslet_kernel_ = std::unique_ptr<FMM<Stk3DFMM>>(
             new FMM<Stk3DFMM>(mult_order, max_pts, PAXIS::NONE, KERNEL::PVel, stokes_pvel_fmm));
+        stresslet_kernel_->set_sort_points(params.stkfmm.sort_points);
+        if (params.mixed_precision.enabled) {
+            stresslet_kernel_low_ = std::make_shared<FMM<Stk3DFMM>>(params.mixed_precision.multipole_order, max_pts,
+                                                                    PAXIS::NONE, KERNEL::PVel, stokes_pvel_fmm);
+            stresslet_kernel_low_->set_sort_points(params.stkfmm.sort_points);
+        }
         redirect.flush(spdlog::level::debug, "STKFMM");
     }
 
     MPI_Comm_rank(MPI_COMM_WORLD, &world_rank_);
     MPI_Comm_size(MPI_COMM_WORLD, &world_size_);
+}
+
+/// @brief Distribute n_nodes nodes over the ranks in contiguous blocks, as evenly as possible
+///
+/// Updates: Periphery::node_counts_, Periphery::node_displs_, Periphery::quad_counts_, Periphery::quad_displs_
+void Periphery::partition_nodes(int n_nodes) {
+    const int node_size_big = 3 * (n_nodes / world_size_ + 1);
+    const int node_size_small = 3 * (n_nodes / world_size_);
+    const int n_nodes_big = n_nodes % world_size_;
+
+    // TODO: prevent overflow for large matrices in periphery import
+    node_counts_.resize(world_size_);
+    node_displs_ = Eigen::VectorXi::Zero(world_size_ + 1);
+    for (int i = 0; i < world_size_; ++i) {
+        node_counts_[i] = ((i < n_nodes_big) ? node_size_big : node_size_small);
+        node_displs_[i + 1] = node_displs_[i] + node_counts_[i];
+    }
+    quad_counts_ = node_counts_ / 3;
+    quad_displs_ = node_displs_ / 3;
+}
 
+Periphery::Periphery(const std::string &precompute_file, const toml::value &body_table, const Params &params)
+    : Periphery(params) {
     cnpy::npz_t precomp;
 
     spdlog::info("Loading raw precomputation data from file {} for periphery into rank 0", precompute_file);
@@ -114,23 +305,11 @@ Periphery::Periphery(const std::string &precompute_file, const toml::value &body
     MPI_Bcast((void *)&n_nodes, 1, MPI_INT, 0, MPI_COMM_WORLD);
 
     const int n_cols = n_rows;
-    const int node_size_big = 3 * (n_nodes / world_size_ + 1);
-    const int node_size_small = 3 * (n_nodes / world_size_);
-    const int node_size_local = (n_nodes % world_size_ > world_rank_) ? node_size_big : node_size_small;
-    const int n_nodes_big = n_nodes % world_size_;
+    partition_nodes(n_nodes);
+    const int node_size_local = node_counts_[world_rank_];
     const int nrows_local = node_size_local;
-
-    // TODO: prevent overflow for large matrices in periphery import
-    node_counts_.resize(world_size_);
-    node_displs_ = Eigen::VectorXi::Zero(world_size_ + 1);
-    for (int i = 0; i < world_size_; ++i) {
-        node_counts_[i] = ((i < n_nodes_big) ? node_size_big : node_size_small);
-        node_displs_[i + 1] = node_displs_[i] + node_counts_[i];
-    }
     row_counts_ = n_cols * node_counts_;
     row_displs_ = n_cols * node_displs_;
-    quad_counts_ = node_counts_ / 3;
-    quad_displs_ = node_displs_ / 3;
 
     const double *M_inv_raw = (world_rank_ == 0) ? precomp["M_inv"].data<double>() : NULL;
     const double *stresslet_plus_complementary_raw =
@@ -139,18 +318,92 @@ Periphery::Periphery(const std::string &precompute_file, const toml::value &body
     const double *nodes_raw = (world_rank_ == 0) ? precomp["nodes"].data<double>() : NULL;
     const double *quadrature_weights_raw = (world_rank_ == 0) ? precomp["quadrature_weights"].data<double>() : NULL;
 
-    // Numpy data is row-major, while eigen is column-major. Easiest way to rectify this is to
-    // load in matrix as its transpose, then transpose back
-    M_inv_.resize(n_cols, nrows_local);
-    MPI_Scatterv(M_inv_raw, row_counts_.data(), row_displs_.data(), MPI_DOUBLE, M_inv_.data(), row_counts_[world_rank_],
-                 MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    // Optionally renumber nodes along a space filling curve, so each rank's contiguous block is a compact patch
+    node_order_ = Eigen::VectorXi::LinSpaced(n_nodes, 0, n_nodes - 1);
+    const bool sorted = params.shell_node_ordering == "morton";
+    Eigen::MatrixXd normals_sorted, nodes_sorted;
+    Eigen::VectorXd quadrature_weights_sorted;
+    if (sorted) {
+        if (world_rank_ == 0) {
+            CMatrixMap nodes(nodes_raw, 3, n_nodes);
+            CMatrixMap normals(normals_raw, 3, n_nodes);
+            CVectorMap quadrature_weights(quadrature_weights_raw, n_nodes);
+            const std::vector<int> order = utils::morton_order(nodes);
+            node_order_ = Eigen::Map<const Eigen::VectorXi>(order.data(), n_nodes);
+
+            nodes_sorted.resize(3, n_nodes);
+            normals_sorted.resize(3, n_nodes);
+            quadrature_weights_sorted.resize(n_nodes);
+            for (int i = 0; i < n_nodes; ++i) {
+                nodes_sorted.col(i) = nodes.col(order[i]);
+                normals_sorted.col(i) = normals.col(order[i]);
+                quadrature_weights_sorted[i] = quadrature_weights[order[i]];
+            }
+
+            normals_raw = normals_sorted.data();
+            nodes_raw = nodes_sorted.data();
+            quadrature_weights_raw = quadrature_weights_sorted.data();
+        }
+        MPI_Bcast(node_order_.data(), n_nodes, MPI_INT, 0, MPI_COMM_WORLD);
+        spdlog::info("Reordered periphery nodes along Morton curve");
+    } else if (params.shell_node_ordering != "index") {
+        throw std::runtime_error("Unknown shell_node_ordering '" + params.shell_node_ordering +
+                                 "'. Valid values are 'index', 'morton'");
+    }
+
+    // Copy the rows of sorted nodes [node_begin, node_end) of a raw operator to dst, permuting the 3x3 node blocks
+    // of the rows and columns through node_order_
+    auto copy_sorted_rows = [&](const double *raw, int node_begin, int node_end, double *dst) {
+        CRowMatrixMap A(raw, n_rows, n_cols);
+        Eigen::Map<RowMatrixXd> A_sorted(dst, 3 * (node_end - node_begin), n_cols);
+        for (int i = node_begin; i < node_end; ++i)
+            for (int j = 0; j < n_nodes; ++j)
+                A_sorted.block<3, 3>(3 * (i - node_begin), 3 * j) =
+                    A.block<3, 3>(3 * node_order_[i], 3 * node_order_[j]);
+    };
 
-    stresslet_plus_complementary_.resize(n_cols, nrows_local);
-    MPI_Scatterv(stresslet_plus_complementary_raw, row_counts_.data(), row_displs_.data(), MPI_DOUBLE,
-                 stresslet_plus_complementary_.data(), row_counts_[world_rank_], MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    // Numpy data is row-major, so the operators are stored row-major and each rank's row block is contiguous.
+    // Either scatter the row blocks to private buffers, or place the whole matrix once per node and map the local
+    // rows out of it. Sorted operators are permuted on the way, so rank 0 never holds a second full copy.
+    auto load_operator = [&](utils::SharedBuffer &buf, const double *raw) -> CRowMatrixMap {
+        if (params.node_shared_operators) {
+            buf = utils::SharedBuffer(size_t(n_rows) * n_cols, true);
+            if (world_rank_ == 0 && sorted)
+                copy_sorted_rows(raw, 0, n_nodes, buf.data());
+            else if (world_rank_ == 0)
+                std::copy(raw, raw + buf.size(), buf.data());
+            buf.broadcast_from_root();
+            return CRowMatrixMap(buf.data() + size_t(node_displs_[world_rank_]) * n_cols, nrows_local, n_cols);
+        }
 
-    M_inv_.transposeInPlace();
-    stresslet_plus_complementary_.transposeInPlace();
+        buf = utils::SharedBuffer(size_t(nrows_local) * n_cols, false);
+        if (!sorted) {
+            MPI_Scatterv(raw, row_counts_.data(), row_displs_.data(), MPI_DOUBLE, buf.data(), row_counts_[world_rank_],
+                         MPI_DOUBLE, 0, MPI_COMM_WORLD);
+        } else if (world_rank_ == 0) {
+            // One rank's row block at a time
+            std::vector<double> rows;
+            for (int rank = 1; rank < world_size_; ++rank) {
+                rows.resize(row_counts_[rank]);
+                copy_sorted_rows(raw, quad_displs_[rank], quad_displs_[rank + 1], rows.data());
+                MPI_Send(rows.data(), row_counts_[rank], MPI_DOUBLE, rank, 0, MPI_COMM_WORLD);
+            }
+            copy_sorted_rows(raw, 0, quad_displs_[1], buf.data());
+        } else {
+            MPI_Recv(buf.data(), row_counts_[world_rank_], MPI_DOUBLE, 0, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        }
+        return CRowMatrixMap(buf.data(), nrows_local, n_cols);
+    };
+
+    new (&M_inv_) CRowMatrixMap(load_operator(M_inv_buf_, M_inv_raw));
+    new (&stresslet_plus_complementary_)
+        CRowMatrixMap(load_operator(stresslet_plus_complementary_buf_, stresslet_plus_complementary_raw));
+    if (params.node_shared_operators)
+        spdlog::info("Periphery operators placed in node shared memory");
+    if (params.mixed_precision.enabled) {
+        M_inv_f_ = M_inv_.cast<float>();
+        stresslet_plus_complementary_f_ = stresslet_plus_complementary_.cast<float>();
+    }
 
     node_normal_.resize(3, node_size_local / 3);
     MPI_Scatterv(normals_raw, node_counts_.data(), node_displs_.data(), MPI_DOUBLE, node_normal_.data(),
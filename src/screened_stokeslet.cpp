@@ -0,0 +1,193 @@
+#include <screened_stokeslet.hpp>
+
+#include <limits>
+
+#include <mpi.h>
+#include <trace.hpp>
+
+namespace {
+/// @brief Send blocks of columns to every rank and receive theirs, in rank order
+/// @param[in] send [ n_rows x sum(send_counts) ] columns to send, grouped by destination rank
+/// @param[in] send_counts,recv_counts [world_size] columns sent to and received from each rank
+/// @return [ n_rows x sum(recv_counts) ] received columns
+Eigen::MatrixXd alltoallv_columns(const Eigen::MatrixXd &send, const std::vector<int> &send_counts,
+                                  const std::vector<int> &recv_counts) {
+    const int n_ranks = send_counts.size();
+    const int n_rows = send.rows();
+    std::vector<int> send_sizes(n_ranks), send_displs(n_ranks), recv_sizes(n_ranks), recv_displs(n_ranks);
+    int n_recv = 0;
+    for (int i = 0, send_offset = 0; i < n_ranks; ++i) {
+        send_sizes[i] = n_rows * send_counts[i];
+        send_displs[i] = send_offset;
+        send_offset += send_sizes[i];
+        recv_sizes[i] = n_rows * recv_counts[i];
+        recv_displs[i] = n_rows * n_recv;
+        n_recv += recv_counts[i];
+    }
+
+    Eigen::MatrixXd recv(n_rows, n_recv);
+    TRACE_SCOPE("MPI_Alltoallv screened halo", "mpi");
+    MPI_Alltoallv(send.data(), send_sizes.data(), send_displs.data(), MPI_DOUBLE, recv.data(), recv_sizes.data(),
+                  recv_displs.data(), MPI_DOUBLE, MPI_COMM_WORLD);
+    return recv;
+}
+} // namespace
+
+/// @param[in] points [ 3 x n_points ] positions to bin
+/// @param[in] cutoff smallest allowed cell width
+CellList::CellList(MatrixRef &points, double cutoff) {
+    const int n_points = points.cols();
+    if (!n_points)
+        return;
+
+    origin_ = points.rowwise().minCoeff();
+    const Eigen::Vector3d extent = points.rowwise().maxCoeff() - origin_;
+
+    // Widen the cells if sparse points would otherwise allocate far more cells than points
+    cell_size_ = cutoff;
+    long n_cells_total;
+    while (true) {
+        n_cells_total = 1;
+        for (int k = 0; k < 3; ++k) {
+            n_cells_[k] = int(extent[k] / cell_size_) + 1;
+            n_cells_total *= n_cells_[k];
+        }
+        if (n_cells_total <= 8L * n_points)
+            break;
+        cell_size_ *= 1.5;
+    }
+
+    // Counting sort of the points by cell
+    std::vector<int> point_cell(n_points);
+    cell_start_.assign(n_cells_total + 1, 0);
+    for (int j = 0; j < n_points; ++j) {
+        int s[3];
+        for (int k = 0; k < 3; ++k)
+            s[k] = std::min(int((points(k, j) - origin_[k]) / cell_size_), n_cells_[k] - 1);
+        point_cell[j] = (s[0] * n_cells_[1] + s[1]) * n_cells_[2] + s[2];
+        cell_start_[point_cell[j] + 1]++;
+    }
+    for (long i = 0; i < n_cells_total; ++i)
+        cell_start_[i + 1] += cell_start_[i];
+
+    std::vector<int> fill(cell_start_.begin(), cell_start_.end() - 1);
+    point_index_.resize(n_points);
+    for (int j = 0; j < n_points; ++j)
+        point_index_[fill[point_cell[j]]++] = j;
+}
+
+/// @brief Gather the sources of other ranks within the cutoff of this rank's targets, and bin all sources
+///
+/// Sources are sent to every rank whose target bounding box, grown by the cutoff, contains them. Positions and groups
+/// travel as 4 doubles per source, so group ids must stay below 2^53.
+void ScreenedStokeslet::update_halo(MatrixRef &r_src, const std::vector<long> &src_group, MatrixRef &r_trg) {
+    TRACE_SCOPE("screened stokeslet halo", "flow");
+    int world_size, world_rank;
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+    MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+
+    // Ranks without targets get an empty (inverted) box
+    double box[6];
+    for (int k = 0; k < 3; ++k) {
+        box[k] = r_trg.cols() ? r_trg.row(k).minCoeff() - cutoff_ : std::numeric_limits<double>::max();
+        box[k + 3] = r_trg.cols() ? r_trg.row(k).maxCoeff() + cutoff_ : std::numeric_limits<double>::lowest();
+    }
+    std::vector<double> boxes(6 * world_size);
+    {
+        TRACE_SCOPE("MPI_Allgather screened boxes", "mpi");
+        MPI_Allgather(box, 6, MPI_DOUBLE, boxes.data(), 6, MPI_DOUBLE, MPI_COMM_WORLD);
+    }
+
+    send_index_.clear();
+    send_counts_.assign(world_size, 0);
+    for (int rank = 0; rank < world_size; ++rank) {
+        if (rank == world_rank)
+            continue;
+        const double *b = &boxes[6 * rank];
+        for (int j = 0; j < r_src.cols(); ++j) {
+            if (r_src(0, j) >= b[0] && r_src(1, j) >= b[1] && r_src(2, j) >= b[2] && r_src(0, j) <= b[3] &&
+                r_src(1, j) <= b[4] && r_src(2, j) <= b[5]) {
+                send_index_.push_back(j);
+                send_counts_[rank]++;
+            }
+        }
+    }
+
+    recv_counts_.resize(world_size);
+    {
+        TRACE_SCOPE("MPI_Alltoall screened counts", "mpi");
+        MPI_Alltoall(send_counts_.data(), 1, MPI_INT, recv_counts_.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    }
+
+    Eigen::MatrixXd send(4, send_index_.size());
+    for (size_t i = 0; i < send_index_.size(); ++i) {
+        send.col(i).head<3>() = r_src.col(send_index_[i]);
+        send(3, i) = src_group[send_index_[i]];
+    }
+    const Eigen::MatrixXd recv = alltoallv_columns(send, send_counts_, recv_counts_);
+    r_halo_ = recv.topRows(3);
+    group_halo_.resize(recv.cols());
+    for (int i = 0; i < recv.cols(); ++i)
+        group_halo_[i] = recv(3, i);
+
+    Eigen::MatrixXd r_all(3, r_src.cols() + r_halo_.cols());
+    r_all << r_src, r_halo_;
+    cells_ = CellList(r_all, cutoff_);
+}
+
+Eigen::MatrixXd ScreenedStokeslet::operator()(MatrixRef &r_src, MatrixRef &density, const std::vector<long> &src_group,
+                                              MatrixRef &r_trg, const std::vector<long> &trg_group, double eta) {
+    TRACE_SCOPE("screened stokeslet", "flow");
+    // The halo depends on every rank's geometry, so it is rebuilt everywhere if any rank's points moved
+    int setup = !has_halo_ || r_src_old_.size() != r_src.size() || r_trg_old_.size() != r_trg.size() ||
+                r_src_old_ != r_src || r_trg_old_ != r_trg;
+    {
+        TRACE_SCOPE("MPI_Allreduce screened setup", "mpi");
+        MPI_Allreduce(MPI_IN_PLACE, &setup, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+    }
+    if (setup) {
+        update_halo(r_src, src_group, r_trg);
+        r_src_old_ = r_src;
+        r_trg_old_ = r_trg;
+        has_halo_ = true;
+    }
+
+    Eigen::MatrixXd send(3, send_index_.size());
+    for (size_t i = 0; i < send_index_.size(); ++i)
+        send.col(i) = density.col(send_index_[i]);
+    const Eigen::MatrixXd density_halo = alltoallv_columns(send, send_counts_, recv_counts_);
+
+    const int n_local = r_src.cols();
+    const int n_trg = r_trg.cols();
+    const double factor = 1.0 / (8.0 * M_PI * eta);
+    const double cutoff2 = cutoff_ * cutoff_;
+    Eigen::MatrixXd res(3, n_trg);
+#pragma omp parallel for schedule(dynamic, 64)
+    for (int i = 0; i < n_trg; ++i) {
+        const Eigen::Vector3d x = r_trg.col(i);
+        const long group = trg_group[i];
+        Eigen::Vector3d u = Eigen::Vector3d::Zero();
+        cells_.for_each_candidate(x, [&](int j) {
+            Eigen::Vector3d dx, f;
+            if (j < n_local) {
+                if (group >= 0 && group == src_group[j])
+                    return;
+                dx = r_src.col(j) - x;
+                f = density.col(j);
+            } else {
+                if (group >= 0 && group == group_halo_[j - n_local])
+                    return;
+                dx = r_halo_.col(j - n_local) - x;
+                f = density_halo.col(j - n_local);
+            }
+            const double r2 = dx.squaredNorm();
+            if (r2 == 0.0 || r2 >= cutoff2)
+                return;
+            const double r = std::sqrt(r2);
+            u += (screening(r) * factor / r) * (f + dx * (dx.dot(f) / r2));
+        });
+        res.col(i) = u;
+    }
+
+    return res;
+}
@@ -0,0 +1,212 @@
+#include <skelly_traj.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <omp.h>
+#include <sys/stat.h>
+
+/// @file
+/// @brief Convert a SkellySim trajectory to ParaView time series (.pvd collections of binary .vtp files)
+///
+/// Frames are converted independently by OpenMP threads. Input files are memory mapped and only one frame per thread is
+/// decoded at a time, so trajectories much larger than memory can be converted.
+///
+/// Usage: skelly_convert [--prefix skelly_sim.out] [--output vtk] [--first 0] [--last -1] [--stride 1]
+///
+/// For segmented trajectories, pass the manifest as the prefix: --prefix skelly_sim.manifest
+
+namespace {
+
+/// One array in a VTK XML file, stored in the appended data section
+struct vtk_array_t {
+    std::string type; ///< VTK type name, "Float64" or "Int64"
+    std::string name;
+    int n_components;
+    const void *data;
+    size_t n_bytes;
+};
+
+template <typename T>
+vtk_array_t make_array(const std::string &name, int n_components, const std::vector<T> &v) {
+    return {std::is_floating_point<T>::value ? "Float64" : "Int64", name, n_components, v.data(), v.size() * sizeof(T)};
+}
+
+/// @brief Write a PolyData file with raw appended binary arrays
+/// @param[in] cell_kind "Lines" or "Verts"
+/// @param[in] cell_arrays connectivity/offsets for cell_kind
+void write_vtp(const std::string &filename, size_t n_points, size_t n_cells, const std::string &cell_kind,
+               const vtk_array_t &points, const std::vector<vtk_array_t> &cell_arrays,
+               const std::vector<vtk_array_t> &point_data, const std::vector<vtk_array_t> &cell_data) {
+    std::ostringstream header;
+    uint64_t offset = 0;
+    auto declare = [&header, &offset](const vtk_array_t &a) {
+        header << "<DataArray type=\"" << a.type << "\" Name=\"" << a.name << "\" NumberOfComponents=\""
+               << a.n_components << "\" format=\"appended\" offset=\"" << offset << "\"/>\n";
+        offset += sizeof(uint64_t) + a.n_bytes;
+    };
+
+    header << "<?xml version=\"1.0\"?>\n"
+           << "<VTKFile type=\"PolyData\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\"UInt64\">\n"
+           << "<PolyData>\n"
+           << "<Piece NumberOfPoints=\"" << n_points << "\" Number" << (cell_kind == "Lines" ? "OfLines" : "OfVerts")
+           << "=\"" << n_cells << "\">\n";
+    header << "<Points>\n";
+    declare(points);
+    header << "</Points>\n<" << cell_kind << ">\n";
+    for (const auto &a : cell_arrays)
+        declare(a);
+    header << "</" << cell_kind << ">\n<PointData>\n";
+    for (const auto &a : point_data)
+        declare(a);
+    header << "</PointData>\n<CellData>\n";
+    for (const auto &a : cell_data)
+        declare(a);
+    header << "</CellData>\n</Piece>\n</PolyData>\n<AppendedData encoding=\"raw\">\n_";
+
+    std::ofstream ofs(filename, std::ios::binary);
+    if (!ofs)
+        throw std::runtime_error("Unable to open " + filename + " for writing");
+    ofs << header.str();
+    auto append = [&ofs](const vtk_array_t &a) {
+        const uint64_t n_bytes = a.n_bytes;
+        ofs.write(reinterpret_cast<const char *>(&n_bytes), sizeof(n_bytes));
+        ofs.write(static_cast<const char *>(a.data), a.n_bytes);
+    };
+    append(points);
+    for (const auto *arrays : {&cell_arrays, &point_data, &cell_data})
+        for (const auto &a : *arrays)
+            append(a);
+    ofs << "\n</AppendedData>\n</VTKFile>\n";
+}
+
+void write_fibers(const std::string &filename, const skelly_traj::Frame &frame) {
+    const size_t n_fibers = frame.n_fibers();
+    const size_t n_points = frame.fiber_offsets.back();
+    std::vector<int64_t> connectivity(n_points);
+    std::iota(connectivity.begin(), connectivity.end(), 0);
+    std::vector<int64_t> offsets(frame.fiber_offsets.begin() + 1, frame.fiber_offsets.end());
+    std::vector<int64_t> n_nodes(frame.fiber_n_nodes.begin(), frame.fiber_n_nodes.end());
+    std::vector<int64_t> binding_site(frame.fiber_binding_site.begin(), frame.fiber_binding_site.end());
+
+    write_vtp(filename, n_points, n_fibers, "Lines", make_array("Points", 3, frame.fiber_x),
+              {make_array("connectivity", 1, connectivity), make_array("offsets", 1, offsets)}, {},
+              {make_array("length", 1, frame.fiber_length),
+               make_array("bending_rigidity", 1, frame.fiber_bending_rigidity), make_array("n_nodes", 1, n_nodes),
+               make_array("binding_site", 2, binding_site)});
+}
+
+void write_bodies(const std::string &filename, const skelly_traj::Frame &frame) {
+    const size_t n_bodies = frame.n_bodies();
+    std::vector<int64_t> connectivity(n_bodies);
+    std::iota(connectivity.begin(), connectivity.end(), 0);
+    std::vector<int64_t> offsets(n_bodies);
+    std::iota(offsets.begin(), offsets.end(), 1);
+
+    write_vtp(filename, n_bodies, n_bodies, "Verts", make_array("Points", 3, frame.body_position),
+              {make_array("connectivity", 1, connectivity), make_array("offsets", 1, offsets)},
+              {make_array("orientation", 4, frame.body_orientation)}, {});
+}
+
+void write_pvd(const std::string &filename, const std::vector<std::pair<double, std::string>> &datasets) {
+    std::ofstream ofs(filename);
+    if (!ofs)
+        throw std::runtime_error("Unable to open " + filename + " for writing");
+    ofs.precision(17);
+    ofs << "<?xml version=\"1.0\"?>\n<VTKFile type=\"Collection\" version=\"1.0\">\n<Collection>\n";
+    for (const auto &[time, file] : datasets)
+        ofs << "<DataSet timestep=\"" << time << "\" part=\"0\" file=\"" << file << "\"/>\n";
+    ofs << "</Collection>\n</VTKFile>\n";
+}
+
+void usage() {
+    std::cerr << "Usage: skelly_convert [--prefix skelly_sim.out] [--output vtk] [--first 0] [--last -1] "
+                 "[--stride 1]\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string prefix = "skelly_sim.out";
+    std::string output = "vtk";
+    long first = 0, last = -1, stride = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h" || i + 1 == argc) {
+            usage();
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+        const std::string val = argv[++i];
+        if (arg == "--prefix")
+            prefix = val;
+        else if (arg == "--output")
+            output = val;
+        else if (arg == "--first")
+            first = std::stol(val);
+        else if (arg == "--last")
+            last = std::stol(val);
+        else if (arg == "--stride")
+            stride = std::max(1L, std::stol(val));
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    try {
+        skelly_traj::Trajectory traj(prefix);
+        const long n_frames = traj.n_frames();
+        if (last < 0 || last >= n_frames)
+            last = n_frames - 1;
+
+        std::vector<long> frames;
+        for (long i = std::max(0L, first); i <= last; i += stride)
+            frames.push_back(i);
+
+        mkdir(output.c_str(), 0755);
+        std::cout << "Converting " << frames.size() << " of " << n_frames << " frames from " << traj.n_ranks()
+                  << " rank files using " << omp_get_max_threads() << " threads\n";
+
+        std::vector<double> times(frames.size());
+        std::vector<std::string> errors(frames.size());
+        double st = omp_get_wtime();
+#pragma omp parallel for schedule(dynamic)
+        for (size_t i = 0; i < frames.size(); ++i) {
+            try {
+                skelly_traj::Frame frame;
+                traj.read_frame(frames[i], frame);
+                times[i] = frame.time;
+                const std::string id = std::to_string(frames[i]);
+                write_fibers(output + "/fibers_" + id + ".vtp", frame);
+                write_bodies(output + "/bodies_" + id + ".vtp", frame);
+            } catch (std::exception &e) {
+                errors[i] = e.what();
+            }
+        }
+        for (const auto &error : errors)
+            if (!error.empty())
+                throw std::runtime_error(error);
+
+        std::vector<std::pair<double, std::string>> fibers, bodies;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            fibers.push_back({times[i], "fibers_" + std::to_string(frames[i]) + ".vtp"});
+            bodies.push_back({times[i], "bodies_" + std::to_string(frames[i]) + ".vtp"});
+        }
+        write_pvd(output + "/fibers.pvd", fibers);
+        write_pvd(output + "/bodies.pvd", bodies);
+        std::cout << "Wrote " << output << "/fibers.pvd and " << output << "/bodies.pvd in " << omp_get_wtime() - st
+                  << " seconds\n";
+    } catch (std::exception &e) {
+        std::cerr << "skelly_convert: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
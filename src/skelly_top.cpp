@@ -0,0 +1,180 @@
+#include <telemetry.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// @file
+/// @brief Live view of a running simulation's telemetry rings (see telemetry.hpp)
+///
+/// Usage: skelly_top [--name skelly_sim] [--interval 1.0] [--window 20] [--once]
+///
+/// Attaches read-only to /<name>.<rank> for every rank on this node and prints, per rank, the latest step and the
+/// throughput over the last `window` records.
+
+namespace {
+
+/// @brief Read-only mapping of one rank's ring
+class RingView {
+  public:
+    RingView(const std::string &shm_name) {
+        int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+        if (fd == -1)
+            return;
+        struct stat sb;
+        if (fstat(fd, &sb) == 0 && size_t(sb.st_size) >= sizeof(telemetry::header_t)) {
+            void *addr = mmap(nullptr, sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            if (addr != MAP_FAILED) {
+                addr_ = addr;
+                size_ = sb.st_size;
+            }
+        }
+        close(fd);
+
+        const auto *header = get_header();
+        if (addr_ && (std::memcmp(header->magic, telemetry::magic, sizeof(telemetry::magic)) ||
+                      header->record_size != sizeof(telemetry::record_t) || header->capacity < 2 ||
+                      sizeof(telemetry::header_t) + header->capacity * sizeof(telemetry::record_t) > size_)) {
+            munmap(addr_, size_);
+            addr_ = nullptr;
+        }
+    }
+    RingView(const RingView &) = delete;
+    ~RingView() {
+        if (addr_)
+            munmap(addr_, size_);
+    }
+
+    bool is_open() const { return addr_ != nullptr; }
+    const telemetry::header_t *get_header() const { return static_cast<const telemetry::header_t *>(addr_); }
+
+    /// @brief Copy out the latest n records, oldest first, discarding any the writer overwrote while copying
+    ///
+    /// Record k lives in slot k % capacity until record k + capacity replaces it. Reading at most capacity - 1 records
+    /// leaves out the slot of record head, which the writer may already be filling. Afterwards, with head_after
+    /// records published, records up to head_after - capacity (the last possibly half written) are stale.
+    std::vector<telemetry::record_t> latest(uint64_t n) const {
+        const auto *header = get_header();
+        const auto *records =
+            reinterpret_cast<const telemetry::record_t *>(static_cast<const char *>(addr_) + sizeof(*header));
+        const uint64_t capacity = header->capacity;
+        const uint64_t head = header->head.load(std::memory_order_acquire);
+        n = std::min({n, head, capacity - 1});
+        const uint64_t first = head - n;
+
+        std::vector<telemetry::record_t> res(n);
+        for (uint64_t i = 0; i < n; ++i)
+            res[i] = records[(first + i) % capacity];
+
+        // Keep the copies above before the second load of head
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t head_after = header->head.load(std::memory_order_relaxed);
+        const uint64_t first_intact = head_after + 1 > capacity ? head_after + 1 - capacity : 0;
+        const uint64_t overwritten = std::min(n, first_intact > first ? first_intact - first : 0);
+        res.erase(res.begin(), res.begin() + overwritten);
+        return res;
+    }
+
+  private:
+    void *addr_ = nullptr;
+    size_t size_ = 0;
+};
+
+/// @brief Ranks of this node with a telemetry object, from the POSIX shared memory directory
+std::vector<int> find_ranks(const std::string &name) {
+    std::vector<int> ranks;
+    const std::string prefix = name + ".";
+    if (DIR *dir = opendir("/dev/shm")) {
+        while (dirent *entry = readdir(dir)) {
+            const std::string file = entry->d_name;
+            if (file.compare(0, prefix.size(), prefix) == 0 &&
+                file.find_first_not_of("0123456789", prefix.size()) == std::string::npos && file.size() > prefix.size())
+                ranks.push_back(std::stoi(file.substr(prefix.size())));
+        }
+        closedir(dir);
+    }
+    std::sort(ranks.begin(), ranks.end());
+    return ranks;
+}
+
+void usage() { std::cerr << "Usage: skelly_top [--name skelly_sim] [--interval 1.0] [--window 20] [--once]\n"; }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::string name = "skelly_sim";
+    double interval = 1.0;
+    uint64_t window = 20;
+    bool once = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--once")
+            once = true;
+        else if (arg == "--name" && i + 1 < argc)
+            name = argv[++i];
+        else if (arg == "--interval" && i + 1 < argc)
+            interval = std::stod(argv[++i]);
+        else if (arg == "--window" && i + 1 < argc)
+            window = std::max(2L, std::stol(argv[++i]));
+        else {
+            usage();
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    while (true) {
+        std::vector<std::unique_ptr<RingView>> rings;
+        int n_ranks = 0;
+        for (int rank : find_ranks(name)) {
+            auto ring = std::make_unique<RingView>(telemetry::shm_name(name, rank));
+            if (!ring->is_open())
+                continue;
+            n_ranks = ring->get_header()->n_ranks;
+            rings.push_back(std::move(ring));
+        }
+
+        if (!once)
+            std::printf("\033[2J\033[H");
+        if (rings.empty()) {
+            std::printf("No telemetry found for '%s' on this node\n", name.c_str());
+        } else {
+            std::printf("%s: %zu of %d ranks on this node\n\n", name.c_str(), rings.size(), n_ranks);
+            std::printf("%5s %8s %12s %10s %9s %9s %6s %10s %8s %8s %8s %8s %10s\n", "rank", "step", "time", "dt",
+                        "steps/s", "simt/s", "iters", "residual", "t_step", "t_setup", "t_solve", "fibers", "rss(MB)");
+            for (const auto &ring : rings) {
+                const auto records = ring->latest(window);
+                if (records.empty())
+                    continue;
+                const auto &last = records.back();
+                const auto &first = records.front();
+                const double elapsed = last.wall_time - first.wall_time;
+                const double steps_per_s = elapsed > 0 ? (last.step - first.step) / elapsed : 0.0;
+                const double simt_per_s = elapsed > 0 ? (last.time - first.time) / elapsed : 0.0;
+                std::printf("%5d %8lu %12.6g %10.3g %9.3g %9.3g %6d %10.3g %8.3g %8.3g %8.3g %8ld %10.1f\n",
+                            ring->get_header()->rank, (unsigned long)last.step, last.time, last.dt, steps_per_s,
+                            simt_per_s, last.gmres_iterations, last.residual, last.t_step, last.t_setup, last.t_solve,
+                            (long)last.n_fibers, last.rss_bytes / 1048576.0);
+            }
+        }
+        std::fflush(stdout);
+
+        if (once)
+            break;
+        std::this_thread::sleep_for(std::chrono::duration<double>(interval));
+    }
+
+    return 0;
+}
@@ -0,0 +1,474 @@
+#include <skelly_traj.h>
+#include <skelly_traj.hpp>
+
+#include <msgpack.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// @file
+/// @brief Implement libskelly_traj, the standalone trajectory reader, and its C interface
+
+namespace skelly_traj {
+
+namespace {
+/// msgpack visitor that only validates the structure, so frames can be skipped without building objects
+struct skip_visitor : msgpack::null_visitor {
+    bool ok = true;
+    void parse_error(size_t, size_t) { ok = false; }
+    void insufficient_bytes(size_t, size_t) { ok = false; }
+};
+
+std::string_view key_of(const msgpack::object_kv &kv) {
+    if (kv.key.type != msgpack::type::STR)
+        return {};
+    return {kv.key.via.str.ptr, kv.key.via.str.size};
+}
+
+const msgpack::object *find_key(const msgpack::object &map, std::string_view key) {
+    if (map.type != msgpack::type::MAP)
+        throw std::runtime_error("Malformed trajectory frame: expected map");
+    for (uint32_t i = 0; i < map.via.map.size; ++i)
+        if (key_of(map.via.map.ptr[i]) == key)
+            return &map.via.map.ptr[i].val;
+    return nullptr;
+}
+
+inline double as_double(const msgpack::object &o) {
+    if (o.type == msgpack::type::FLOAT64 || o.type == msgpack::type::FLOAT32)
+        return o.via.f64;
+    return o.as<double>();
+}
+
+/// @brief Append the entries of a serialized Eigen object (["__eigen__", (rows, cols,)? values...]) to out
+/// @return number of values appended
+size_t append_eigen(const msgpack::object &o, size_t header, std::vector<double> &out) {
+    if (o.type != msgpack::type::ARRAY || o.via.array.size < header)
+        throw std::runtime_error("Malformed trajectory frame: expected serialized Eigen object");
+    const msgpack::object *p = o.via.array.ptr;
+    for (uint32_t i = header; i < o.via.array.size; ++i)
+        out.push_back(as_double(p[i]));
+    return o.via.array.size - header;
+}
+
+/// Containers are serialized as a one element array holding the list of objects
+const msgpack::object &unwrap_container(const msgpack::object &o) {
+    if (o.type == msgpack::type::ARRAY && o.via.array.size == 1 && o.via.array.ptr[0].type == msgpack::type::ARRAY)
+        return o.via.array.ptr[0];
+    return o;
+}
+
+/// @brief Append a column of n raw doubles (msgpack bin) to out
+void append_column(const msgpack::object *col, size_t n, std::vector<double> &out) {
+    if (!col || col->type != msgpack::type::BIN || col->via.bin.size != n * sizeof(double))
+        throw std::runtime_error("Malformed trajectory frame: bad fiber column");
+    const size_t size = out.size();
+    out.resize(size + n);
+    std::memcpy(out.data() + size, col->via.bin.ptr, n * sizeof(double));
+}
+
+/// @brief Read the columnar fiber layout (see FiberContainer::msgpack_pack)
+/// @param[in] params_fibers fiber columns of the frame holding the constant parameters, if not this one
+void read_fiber_columns(const msgpack::object &fibers, const msgpack::object *params_fibers, Frame &frame) {
+    const msgpack::object *n_nodes = find_key(fibers, "n_nodes");
+    const msgpack::object *binding_site = find_key(fibers, "binding_site");
+    if (!n_nodes || n_nodes->type != msgpack::type::ARRAY || !binding_site ||
+        binding_site->type != msgpack::type::ARRAY || binding_site->via.array.size != 2 * n_nodes->via.array.size)
+        throw std::runtime_error("Malformed trajectory frame: bad fiber n_nodes/binding_site");
+
+    const uint32_t n_fibers = n_nodes->via.array.size;
+    if (frame.fiber_offsets.empty())
+        frame.fiber_offsets.push_back(0);
+    const int64_t first_node = frame.fiber_offsets.back();
+    for (uint32_t i = 0; i < n_fibers; ++i) {
+        frame.fiber_n_nodes.push_back(n_nodes->via.array.ptr[i].as<int32_t>());
+        frame.fiber_offsets.push_back(frame.fiber_offsets.back() + frame.fiber_n_nodes.back());
+    }
+    for (uint32_t i = 0; i < 2 * n_fibers; ++i)
+        frame.fiber_binding_site.push_back(binding_site->via.array.ptr[i].as<int32_t>());
+
+    append_column(find_key(fibers, "length"), n_fibers, frame.fiber_length);
+    append_column(find_key(fibers, "x"), 3 * (frame.fiber_offsets.back() - first_node), frame.fiber_x);
+    const msgpack::object *bending_rigidity = find_key(fibers, "bending_rigidity");
+    if (!bending_rigidity && params_fibers)
+        bending_rigidity = find_key(*params_fibers, "bending_rigidity");
+    append_column(bending_rigidity, n_fibers, frame.fiber_bending_rigidity);
+}
+
+void read_fibers(const msgpack::object &fibers_obj, Frame &frame) {
+    const msgpack::object &fibers = unwrap_container(fibers_obj);
+    if (fibers.type != msgpack::type::ARRAY)
+        throw std::runtime_error("Malformed trajectory frame: expected fiber list");
+
+    const uint32_t n_fibers = fibers.via.array.size;
+    frame.fiber_n_nodes.reserve(frame.fiber_n_nodes.size() + n_fibers);
+    frame.fiber_length.reserve(frame.fiber_length.size() + n_fibers);
+    frame.fiber_bending_rigidity.reserve(frame.fiber_bending_rigidity.size() + n_fibers);
+    frame.fiber_binding_site.reserve(frame.fiber_binding_site.size() + 2 * n_fibers);
+    if (frame.fiber_offsets.empty())
+        frame.fiber_offsets.push_back(0);
+
+    for (uint32_t i_fib = 0; i_fib < n_fibers; ++i_fib) {
+        const msgpack::object &fib = fibers.via.array.ptr[i_fib];
+        if (fib.type != msgpack::type::MAP)
+            throw std::runtime_error("Malformed trajectory frame: expected fiber map");
+
+        int32_t n_nodes = 0, body = -1, site = -1;
+        double length = 0.0, bending_rigidity = 0.0;
+        size_t n_x = 0;
+        for (uint32_t i = 0; i < fib.via.map.size; ++i) {
+            const auto &kv = fib.via.map.ptr[i];
+            const std::string_view key = key_of(kv);
+            if (key == "n_nodes_")
+                n_nodes = kv.val.as<int32_t>();
+            else if (key == "length_")
+                length = as_double(kv.val);
+            else if (key == "bending_rigidity_")
+                bending_rigidity = as_double(kv.val);
+            else if (key == "binding_site_" && kv.val.type == msgpack::type::ARRAY && kv.val.via.array.size == 2) {
+                body = kv.val.via.array.ptr[0].as<int32_t>();
+                site = kv.val.via.array.ptr[1].as<int32_t>();
+            } else if (key == "x_")
+                n_x = append_eigen(kv.val, 3, frame.fiber_x);
+        }
+        if (n_x != 3 * size_t(n_nodes))
+            throw std::runtime_error("Malformed trajectory frame: fiber n_nodes_ doesn't match x_");
+
+        frame.fiber_n_nodes.push_back(n_nodes);
+        frame.fiber_offsets.push_back(frame.fiber_offsets.back() + n_nodes);
+        frame.fiber_length.push_back(length);
+        frame.fiber_bending_rigidity.push_back(bending_rigidity);
+        frame.fiber_binding_site.push_back(body);
+        frame.fiber_binding_site.push_back(site);
+    }
+}
+
+void read_bodies(const msgpack::object &bodies_obj, Frame &frame) {
+    const msgpack::object &bodies = unwrap_container(bodies_obj);
+    if (bodies.type != msgpack::type::ARRAY)
+        throw std::runtime_error("Malformed trajectory frame: expected body list");
+
+    for (uint32_t i_body = 0; i_body < bodies.via.array.size; ++i_body) {
+        const msgpack::object &body = bodies.via.array.ptr[i_body];
+        const msgpack::object *position = find_key(body, "position_");
+        const msgpack::object *orientation = find_key(body, "orientation_");
+        if (!position || !orientation || append_eigen(*position, 3, frame.body_position) != 3 ||
+            append_eigen(*orientation, 1, frame.body_orientation) != 4)
+            throw std::runtime_error("Malformed trajectory frame: bad body entry");
+    }
+}
+} // namespace
+
+void Frame::clear() {
+    time = dt = 0.0;
+    fiber_n_nodes.clear();
+    fiber_offsets.clear();
+    fiber_length.clear();
+    fiber_bending_rigidity.clear();
+    fiber_binding_site.clear();
+    fiber_x.clear();
+    body_position.clear();
+    body_orientation.clear();
+}
+
+/// @brief Append the fibers of another (rank's) frame to this one
+void Frame::append_fibers(const Frame &other) {
+    if (fiber_offsets.empty())
+        fiber_offsets.push_back(0);
+    const int64_t node_offset = fiber_offsets.back();
+    for (size_t i = 1; i < other.fiber_offsets.size(); ++i)
+        fiber_offsets.push_back(other.fiber_offsets[i] + node_offset);
+
+    fiber_n_nodes.insert(fiber_n_nodes.end(), other.fiber_n_nodes.begin(), other.fiber_n_nodes.end());
+    fiber_length.insert(fiber_length.end(), other.fiber_length.begin(), other.fiber_length.end());
+    fiber_bending_rigidity.insert(fiber_bending_rigidity.end(), other.fiber_bending_rigidity.begin(),
+                                  other.fiber_bending_rigidity.end());
+    fiber_binding_site.insert(fiber_binding_site.end(), other.fiber_binding_site.begin(),
+                              other.fiber_binding_site.end());
+    fiber_x.insert(fiber_x.end(), other.fiber_x.begin(), other.fiber_x.end());
+}
+
+RankFile::RankFile(const std::string &filename) : filename_(filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("Unable to open trajectory file " + filename);
+
+    struct stat sb;
+    if (fstat(fd, &sb) == -1) {
+        close(fd);
+        throw std::runtime_error("Error statting " + filename);
+    }
+    size_ = sb.st_size;
+
+    if (size_) {
+        void *addr = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0u);
+        close(fd);
+        if (addr == MAP_FAILED)
+            throw std::runtime_error("Error mapping " + filename);
+        addr_ = static_cast<const char *>(addr);
+    } else {
+        close(fd);
+    }
+
+    const std::string index_file = filename + ".idx";
+    const uint64_t cached_end = load_index(index_file) ? indexed_end_ : 0;
+    build_index();
+    if (indexed_end_ != cached_end || !cached_end)
+        save_index(index_file);
+}
+
+RankFile::~RankFile() {
+    if (addr_)
+        munmap(const_cast<char *>(addr_), size_);
+}
+
+/// @brief Scan frames after the last indexed one, stopping at the end of the file or at a truncated frame
+void RankFile::build_index() {
+    size_t offset = indexed_end_;
+    while (offset < size_) {
+        skip_visitor visitor;
+        size_t next = offset;
+        if (!msgpack::parse(addr_, size_, next, visitor) || !visitor.ok || next <= offset)
+            break;
+        offsets_.push_back(offset);
+        offset = next;
+    }
+    indexed_end_ = offset;
+}
+
+/// @brief Load a cached index, if it's consistent with the current file
+///
+/// Format: "SKIDX001", uint64 end of the last indexed frame, uint64 n, then n uint64 frame offsets
+bool RankFile::load_index(const std::string &index_file) {
+    std::ifstream ifs(index_file, std::ios::binary);
+    if (!ifs)
+        return false;
+
+    char magic[8];
+    uint64_t end, n;
+    if (!ifs.read(magic, 8) || std::memcmp(magic, "SKIDX001", 8) || !ifs.read(reinterpret_cast<char *>(&end), 8) ||
+        !ifs.read(reinterpret_cast<char *>(&n), 8) || end > size_)
+        return false;
+    offsets_.resize(n);
+    if (!ifs.read(reinterpret_cast<char *>(offsets_.data()), n * sizeof(uint64_t))) {
+        offsets_.clear();
+        return false;
+    }
+
+    // Guard against a trajectory that was overwritten since: the last indexed frame must end where the index does
+    if (n) {
+        skip_visitor visitor;
+        size_t next = offsets_.back();
+        if (next >= end || !msgpack::parse(addr_, size_, next, visitor) || !visitor.ok || next != end) {
+            offsets_.clear();
+            return false;
+        }
+    }
+    indexed_end_ = end;
+    return true;
+}
+
+/// @brief Cache the index next to the trajectory. Failure (e.g. read-only directory) is not an error.
+void RankFile::save_index(const std::string &index_file) const {
+    std::ofstream ofs(index_file, std::ios::binary | std::ios::trunc);
+    if (!ofs)
+        return;
+    const uint64_t n = offsets_.size();
+    ofs.write("SKIDX001", 8);
+    ofs.write(reinterpret_cast<const char *>(&indexed_end_), 8);
+    ofs.write(reinterpret_cast<const char *>(&n), 8);
+    ofs.write(reinterpret_cast<const char *>(offsets_.data()), n * sizeof(uint64_t));
+}
+
+/// @brief Decode one frame of this rank, appending its fibers (and optionally bodies) to frame
+void RankFile::read_frame(std::size_t i_frame, Frame &frame, bool with_bodies) const {
+    if (i_frame >= n_frames())
+        throw std::runtime_error("Frame " + std::to_string(i_frame) + " out of range in " + filename_);
+
+    size_t offset = offsets_[i_frame];
+    msgpack::object_handle oh;
+    msgpack::unpack(oh, addr_, size_, offset);
+    const msgpack::object &obj = oh.get();
+
+    const msgpack::object *time = find_key(obj, "time");
+    const msgpack::object *dt = find_key(obj, "dt");
+    if (!time || !dt)
+        throw std::runtime_error("Malformed trajectory frame: missing time/dt in " + filename_);
+    frame.time = as_double(*time);
+    frame.dt = as_double(*dt);
+
+    const msgpack::object *fibers = find_key(obj, "fibers");
+    if (fibers && fibers->type == msgpack::type::MAP) {
+        // Columnar frames may refer to an earlier frame for the constant fiber parameters
+        msgpack::object_handle oh_params;
+        const msgpack::object *params_fibers = nullptr;
+        if (!find_key(*fibers, "bending_rigidity")) {
+            const msgpack::object *params_frame = find_key(obj, "fiber_params_frame");
+            if (!params_frame || params_frame->as<int64_t>() < 0 || params_frame->as<uint64_t>() >= n_frames())
+                throw std::runtime_error("Malformed trajectory frame: bad fiber_params_frame in " + filename_);
+            size_t params_offset = offsets_[params_frame->as<uint64_t>()];
+            msgpack::unpack(oh_params, addr_, size_, params_offset);
+            params_fibers = find_key(oh_params.get(), "fibers");
+        }
+        read_fiber_columns(*fibers, params_fibers, frame);
+    } else if (fibers) {
+        read_fibers(*fibers, frame);
+    }
+    if (with_bodies)
+        if (const msgpack::object *bodies = find_key(obj, "bodies"))
+            read_bodies(*bodies, frame);
+}
+
+/// @brief Open a trajectory
+/// @param[in] path either a segment manifest (skelly_sim.manifest), or the path to the rank files without the rank
+/// suffix, e.g. "run/skelly_sim.out"
+Trajectory::Trajectory(const std::string &path) {
+    std::ifstream manifest(path);
+    std::string line;
+    if (manifest && std::getline(manifest, line) && line == "# skelly_sim manifest") {
+        // Segment prefixes are relative to the manifest's directory
+        const size_t slash = path.rfind('/');
+        const std::string dir = slash == std::string::npos ? "" : path.substr(0, slash + 1);
+        while (std::getline(manifest, line)) {
+            std::istringstream iss(line);
+            std::string prefix;
+            if (line.empty() || line[0] == '#' || !(iss >> prefix))
+                continue;
+            add_segment(dir + prefix);
+        }
+        if (segments_.empty())
+            throw std::runtime_error("No segments listed in " + path);
+    } else {
+        add_segment(path);
+    }
+}
+
+/// @brief Open all rank files <prefix>.0, <prefix>.1, ... of one segment
+void Trajectory::add_segment(const std::string &prefix) {
+    segment_t seg;
+    for (int rank = 0;; ++rank) {
+        const std::string filename = prefix + "." + std::to_string(rank);
+        if (access(filename.c_str(), R_OK) != 0)
+            break;
+        seg.files.emplace_back(std::make_unique<RankFile>(filename));
+    }
+    if (seg.files.empty())
+        throw std::runtime_error("No trajectory files found for " + prefix);
+    if (!segments_.empty() && seg.files.size() != n_ranks())
+        throw std::runtime_error("Rank count of " + prefix + " differs from the first segment");
+
+    seg.n_frames = seg.files[0]->n_frames();
+    for (const auto &file : seg.files)
+        seg.n_frames = std::min(seg.n_frames, file->n_frames());
+    seg.first_frame = n_frames_;
+    n_frames_ += seg.n_frames;
+    segments_.push_back(std::move(seg));
+}
+
+/// @brief Read one frame from every rank, concatenating fibers in rank order
+///
+/// Ranks are decoded in parallel. Bodies are replicated on every rank, so they are taken from rank 0.
+void Trajectory::read_frame(std::size_t i_frame, Frame &frame) const {
+    if (i_frame >= n_frames_)
+        throw std::runtime_error("Frame " + std::to_string(i_frame) + " out of range");
+
+    auto seg = std::upper_bound(segments_.begin(), segments_.end(), i_frame,
+                                [](std::size_t i, const segment_t &s) { return i < s.first_frame; }) -
+               1;
+    const auto &files = seg->files;
+    const std::size_t i_local = i_frame - seg->first_frame;
+
+    std::vector<Frame> rank_frames(files.size());
+    std::vector<std::string> errors(files.size());
+#pragma omp parallel for schedule(dynamic)
+    for (size_t rank = 0; rank < files.size(); ++rank) {
+        try {
+            files[rank]->read_frame(i_local, rank_frames[rank], rank == 0);
+        } catch (std::exception &e) {
+            errors[rank] = e.what();
+        }
+    }
+    for (const auto &error : errors)
+        if (!error.empty())
+            throw std::runtime_error(error);
+
+    frame = std::move(rank_frames[0]);
+    for (size_t rank = 1; rank < files.size(); ++rank) {
+        if (rank_frames[rank].time != frame.time || rank_frames[rank].dt != frame.dt)
+            throw std::runtime_error("Rank " + std::to_string(rank) + " out of sync with rank 0 at frame " +
+                                     std::to_string(i_frame));
+        frame.append_fibers(rank_frames[rank]);
+    }
+    if (frame.fiber_offsets.empty())
+        frame.fiber_offsets.push_back(0);
+}
+
+} // namespace skelly_traj
+
+/// Handle behind the C interface: the trajectory plus storage for the last loaded frame
+struct skelly_traj_handle {
+    skelly_traj::Trajectory trajectory;
+    skelly_traj::Frame frame;
+};
+
+namespace {
+thread_local std::string last_error;
+}
+
+extern "C" {
+
+skelly_traj_t *skelly_traj_open(const char *prefix) {
+    try {
+        return new skelly_traj_handle{skelly_traj::Trajectory(prefix), {}};
+    } catch (std::exception &e) {
+        last_error = e.what();
+        return nullptr;
+    }
+}
+
+void skelly_traj_close(skelly_traj_t *traj) { delete traj; }
+
+int64_t skelly_traj_n_frames(const skelly_traj_t *traj) { return traj ? traj->trajectory.n_frames() : 0; }
+
+int64_t skelly_traj_n_ranks(const skelly_traj_t *traj) { return traj ? traj->trajectory.n_ranks() : 0; }
+
+int skelly_traj_load_frame(skelly_traj_t *traj, int64_t i_frame, skelly_traj_frame_t *frame) {
+    if (!traj || !frame || i_frame < 0) {
+        last_error = "Invalid argument to skelly_traj_load_frame";
+        return 1;
+    }
+    try {
+        traj->trajectory.read_frame(i_frame, traj->frame);
+    } catch (std::exception &e) {
+        last_error = e.what();
+        return 1;
+    }
+
+    const skelly_traj::Frame &f = traj->frame;
+    frame->time = f.time;
+    frame->dt = f.dt;
+    frame->n_fibers = f.n_fibers();
+    frame->n_nodes = f.fiber_offsets.back();
+    frame->fiber_n_nodes = f.fiber_n_nodes.data();
+    frame->fiber_offsets = f.fiber_offsets.data();
+    frame->fiber_length = f.fiber_length.data();
+    frame->fiber_bending_rigidity = f.fiber_bending_rigidity.data();
+    frame->fiber_binding_site = f.fiber_binding_site.data();
+    frame->fiber_x = f.fiber_x.data();
+    frame->n_bodies = f.n_bodies();
+    frame->body_position = f.body_position.data();
+    frame->body_orientation = f.body_orientation.data();
+    return 0;
+}
+
+const char *skelly_traj_last_error(void) { return last_error.c_str(); }
+}
@@ -1,16 +1,111 @@
 #include <params.hpp>
 #include <solver_hydro.hpp>
 #include <system.hpp>
+#include <trace.hpp>
 #include <utils.hpp>
 
 #include <Teuchos_ParameterList.hpp>
 
 #include <BelosLinearProblem.hpp>
-#include <BelosPseudoBlockGmresSolMgr.hpp>
+#include <BelosSolverFactory.hpp>
+#include <BelosSolverFactory_Tpetra.hpp>
 #include <BelosTpetraAdapter.hpp>
 
+#include <Eigen/LU>
+
 #include <spdlog/spdlog.h>
 
+namespace {
+/// @brief Sum local partial sums over all ranks, in place
+void allreduce_sum(float *data, int n) {
+    TRACE_SCOPE("MPI_Allreduce inner GMRES", "mpi");
+    MPI_Allreduce(MPI_IN_PLACE, data, n, MPI_FLOAT, MPI_SUM, MPI_COMM_WORLD);
+}
+
+template <typename Derived>
+typename Derived::Scalar global_norm(const Eigen::MatrixBase<Derived> &x) {
+    double sq = x.squaredNorm();
+    MPI_Allreduce(MPI_IN_PLACE, &sq, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    return std::sqrt(sq);
+}
+
+/// @brief Restarted, right preconditioned GMRES in single precision, from a zero initial guess
+///
+/// Solves \f$ A M^{-1} u = b \f$, \f$ x = M^{-1} u \f$. Orthogonalization is classical Gram-Schmidt with one
+/// reorthogonalization, so each iteration takes two packed reductions plus one for the norm.
+/// @param[in] A operator, float vector to float vector
+/// @param[in] M_inv preconditioner, float vector to float vector
+/// @param[in] b right hand side
+/// @param[in] tol relative residual tolerance
+/// @param[in] restart Krylov subspace size
+/// @param[in] max_iter iteration limit
+/// @param[out] n_iter iterations performed
+/// @return approximate solution x
+template <typename op_t, typename prec_t>
+Eigen::VectorXf gmres_float(const op_t &A, const prec_t &M_inv, const Eigen::VectorXf &b, float tol, int restart,
+                            int max_iter, int &n_iter) {
+    using Eigen::MatrixXf;
+    using Eigen::VectorXf;
+    VectorXf x = VectorXf::Zero(b.size());
+    const float b_norm = global_norm(b);
+    n_iter = 0;
+    if (b_norm == 0.0f)
+        return x;
+
+    MatrixXf V(b.size(), restart + 1);
+    MatrixXf H(restart + 1, restart);
+    VectorXf cs(restart), sn(restart), g(restart + 1);
+    VectorXf r = b;
+    float beta = b_norm;
+    while (true) {
+        V.col(0) = r / beta;
+        H.setZero();
+        g.setZero();
+        g[0] = beta;
+        float res = beta;
+        int k = 0;
+        for (; k < restart && n_iter < max_iter && res > tol * b_norm; ++k, ++n_iter) {
+            VectorXf w = A(M_inv(V.col(k)));
+            for (int pass = 0; pass < 2; ++pass) {
+                VectorXf h = V.leftCols(k + 1).transpose() * w;
+                allreduce_sum(h.data(), k + 1);
+                w -= V.leftCols(k + 1) * h;
+                H.col(k).head(k + 1) += h;
+            }
+            H(k + 1, k) = global_norm(w);
+            if (H(k + 1, k) > 0.0f)
+                V.col(k + 1) = w / H(k + 1, k);
+            else
+                V.col(k + 1).setZero();
+
+            // Apply the previous Givens rotations to the new column, then eliminate its subdiagonal
+            for (int i = 0; i < k; ++i) {
+                const float t = cs[i] * H(i, k) + sn[i] * H(i + 1, k);
+                H(i + 1, k) = -sn[i] * H(i, k) + cs[i] * H(i + 1, k);
+                H(i, k) = t;
+            }
+            const float d = std::hypot(H(k, k), H(k + 1, k));
+            cs[k] = d > 0.0f ? H(k, k) / d : 1.0f;
+            sn[k] = d > 0.0f ? H(k + 1, k) / d : 0.0f;
+            H(k, k) = d;
+            H(k + 1, k) = 0.0f;
+            g[k + 1] = -sn[k] * g[k];
+            g[k] = cs[k] * g[k];
+            res = std::abs(g[k + 1]);
+        }
+
+        if (k > 0) {
+            const VectorXf y = H.topLeftCorner(k, k).triangularView<Eigen::Upper>().solve(g.head(k));
+            x += M_inv(V.leftCols(k) * y);
+        }
+        if (k == 0 || res <= tol * b_norm || n_iter >= max_iter)
+            return x;
+        r = b - A(x);
+        beta = global_norm(r);
+    }
+}
+} // namespace
+
 P_inv_hydro::P_inv_hydro(const Teuchos::RCP<const Teuchos::Comm<int>> comm) : comm_(comm), rank_(comm->getRank()) {
     TEUCHOS_TEST_FOR_EXCEPTION(comm.is_null(), std::invalid_argument,
                                "P_inv_hydro constructor: The input Teuchos::Comm object must be nonnull.");
@@ -62,9 +157,11 @@ void Solver<P_inv_hydro, A_fiber_hydro>::set_RHS() {
     RHS_body = System::get_body_RHS();
 }
 
+/// @brief Solve with the Krylov method of Params::krylov
+/// @return true if Belos reports convergence to Params::gmres_tol
 template <>
 bool Solver<P_inv_hydro, A_fiber_hydro>::solve() {
-    const int rank = comm_->getRank();
+    const auto &krylov = System::get_params()->krylov;
     Belos::LinearProblem<ST, MV, OP> problem(matvec_, X_, RHS_);
     problem.setRightPrec(preconditioner_);
     bool set = problem.setProblem();
@@ -72,27 +169,166 @@ bool Solver<P_inv_hydro, A_fiber_hydro>::solve() {
     Teuchos::ParameterList belosList;
     // allowed
     belosList.set("Convergence Tolerance", System::get_params()->gmres_tol); // Relative convergence tolerance requested
-    belosList.set("Orthogonalization", "ICGS");                              // Orthogonalization type
+    belosList.set("Orthogonalization", krylov.orthogonalization);          // Orthogonalization type
+    belosList.set("Num Blocks", krylov.restart);
+    if (krylov.method == "TPETRA GMRES S-STEP")
+        belosList.set("Step Size", krylov.step_size);
     belosList.set("Verbosity",
                   Belos::MsgType::IterationDetails + Belos::MsgType::FinalSummary + Belos::MsgType::StatusTestDetails);
     belosList.set("Output Frequency", 1);
     belosList.set("Output Style", Belos::OutputType::General);
 
-    Belos::PseudoBlockGmresSolMgr<ST, MV, OP> solver(rcpFromRef(problem), rcpFromRef(belosList));
+    Belos::SolverFactory<ST, MV, OP> factory;
+    Teuchos::RCP<Belos::SolverManager<ST, MV, OP>> solver;
+    try {
+        solver = factory.create(krylov.method, rcpFromRef(belosList));
+    } catch (const std::exception &e) {
+        throw std::runtime_error("Unable to create Krylov solver '" + krylov.method + "': " + e.what());
+    }
+    solver->setProblem(rcpFromRef(problem));
     utils::LoggerRedirect redirect(std::cout);
 
     double st = omp_get_wtime();
-    Belos::ReturnType ret = solver.solve();
+    Belos::ReturnType ret;
+    {
+        TRACE_SCOPE("GMRES", "solver");
+        ret = solver->solve();
+    }
     redirect.flush(spdlog::level::trace, "Belos");
+    n_iterations_ = solver->getNumIters();
+    const double dt_solve = omp_get_wtime() - st;
+    const double dt_iter = n_iterations_ ? dt_solve / n_iterations_ : 0.0;
 
     if (ret == Belos::Converged) {
-        spdlog::info("Solver converged with parameters: iters {}, time {}, achieved tolerance {}", solver.getNumIters(),
-                     omp_get_wtime() - st, solver.achievedTol());
+        spdlog::info("Solver converged with parameters: iters {}, time {}, time/iter {}, achieved tolerance {}",
+                     n_iterations_, dt_solve, dt_iter, solver->achievedTol());
     } else {
-        spdlog::info("Solver failed to converge with parameters: iters {}, time {}, achieved tolerance {}",
-                     solver.getNumIters(), omp_get_wtime() - st, solver.achievedTol());
-        spdlog::info("loss of accuracy: {}", solver.isLOADetected());
+        spdlog::info("Solver failed to converge with parameters: iters {}, time {}, time/iter {}, achieved "
+                     "tolerance {}",
+                     n_iterations_, dt_solve, dt_iter, solver->achievedTol());
+        spdlog::info("loss of accuracy: {}", solver->isLOADetected());
     }
 
     return ret == Belos::Converged;
 }
+
+/// @brief Solve with double precision iterative refinement around single precision GMRES
+///
+/// Each refinement step computes the residual \f$ r = b - A x \f$ in double precision, solves \f$ A d = r \f$ to
+/// Params::mixed_precision::inner_tol with GMRES on float vectors, and updates \f$ x = x + d \f$. The inner solves use
+/// the single precision fiber and shell preconditioners and a cheaper operator: System::apply_matvec with the fiber and
+/// shell FMMs at Params::mixed_precision::multipole_order and the dense shell operator in float. Its error only slows
+/// the refinement, since residuals always use the full operator. A step that does not reduce the residual is
+/// discarded, and the refinement stops at the previous iterate.
+/// @return true if the relative residual reached Params::gmres_tol
+template <>
+bool Solver<P_inv_hydro, A_fiber_hydro>::solve_mixed_precision() {
+    const Params &params = *System::get_params();
+    const auto &mp = params.mixed_precision;
+    auto A = [](const Eigen::VectorXf &x) -> Eigen::VectorXf {
+        const Eigen::VectorXd x_d = x.cast<double>();
+        return System::apply_matvec(x_d, true).cast<float>();
+    };
+    auto M_inv = [](const Eigen::VectorXf &x) -> Eigen::VectorXf {
+        const Eigen::VectorXd x_d = x.cast<double>();
+        return System::apply_preconditioner(x_d, true).cast<float>();
+    };
+
+    double st = omp_get_wtime();
+    VectorMap x(X_->getDataNonConst(0).getRawPtr(), X_->getLocalLength());
+    CVectorMap b(RHS_->getData(0).getRawPtr(), RHS_->getLocalLength());
+    x.setZero();
+    const double b_norm = global_norm(b);
+    auto relative = [b_norm](double r_norm) { return b_norm > 0.0 ? r_norm / b_norm : r_norm; };
+    Eigen::VectorXd r = b;
+    double r_norm = global_norm(r);
+    double residual = relative(r_norm);
+    int n_refinements = 0;
+    n_iterations_ = 0;
+    while (residual > params.gmres_tol && n_refinements < mp.max_refinements) {
+        // Solve for the correction scaled to unit norm, which keeps the float solve far from under/overflow
+        int n_inner;
+        const Eigen::VectorXf d = gmres_float(A, M_inv, (r / r_norm).cast<float>(), mp.inner_tol, mp.restart,
+                                              mp.max_inner_iterations, n_inner);
+        const Eigen::VectorXd x_new = x + r_norm * d.cast<double>();
+        Eigen::VectorXd r_new = b - System::apply_matvec(x_new);
+        const double r_norm_new = global_norm(r_new);
+        n_iterations_ += n_inner;
+        n_refinements++;
+        spdlog::debug("Refinement step {}: relative residual {}", n_refinements, relative(r_norm_new));
+        if (relative(r_norm_new) >= residual)
+            break;
+
+        x = x_new;
+        r = std::move(r_new);
+        r_norm = r_norm_new;
+        residual = relative(r_norm);
+    }
+
+    const bool converged = residual <= params.gmres_tol;
+    spdlog::info("Mixed precision solver {} with parameters: refinements {}, inner iters {}, time {}, achieved "
+                 "tolerance {}",
+                 converged ? "converged" : "failed to converge", n_refinements, n_iterations_, omp_get_wtime() - st,
+                 residual);
+    return converged;
+}
+
+/// @brief Solve by assembling the global operator and factorizing it with a dense LU
+///
+/// Column j of the operator is System::apply_matvec of the j-th unit vector, so assembly costs one matvec per global
+/// unknown and no preconditioner. Each rank assembles its rows, then every rank gathers the full matrix and factorizes
+/// it redundantly. The result is independent of Krylov convergence and, for a fixed rank count, bitwise reproducible.
+/// @return true if the relative residual is within Params::gmres_tol
+template <>
+bool Solver<P_inv_hydro, A_fiber_hydro>::solve_direct() {
+    TRACE_SCOPE("direct solve", "solver");
+    using row_matrix_t = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    const int rank = comm_->getRank();
+    const int size = comm_->getSize();
+    const int n_local = X_->getLocalLength();
+    const int n_global = get_global_size();
+
+    std::vector<int> counts(size), displs(size);
+    MPI_Allgather(&n_local, 1, MPI_INT, counts.data(), 1, MPI_INT, MPI_COMM_WORLD);
+    for (int i = 1; i < size; ++i)
+        displs[i] = displs[i - 1] + counts[i - 1];
+    const int offset = displs[rank];
+
+    double st = omp_get_wtime();
+    row_matrix_t A_local(n_local, n_global);
+    Eigen::VectorXd e = Eigen::VectorXd::Zero(n_local);
+    for (int j = 0; j < n_global; ++j) {
+        const bool owner = j >= offset && j < offset + n_local;
+        if (owner)
+            e[j - offset] = 1.0;
+        A_local.col(j) = System::apply_matvec(e);
+        if (owner)
+            e[j - offset] = 0.0;
+    }
+    const double t_assemble = omp_get_wtime() - st;
+
+    st = omp_get_wtime();
+    Eigen::VectorXd b(n_global);
+    MPI_Allgatherv(RHS_->getData(0).getRawPtr(), n_local, MPI_DOUBLE, b.data(), counts.data(), displs.data(),
+                   MPI_DOUBLE, MPI_COMM_WORLD);
+    row_matrix_t A(n_global, n_global);
+    for (int i = 0; i < size; ++i) {
+        counts[i] *= n_global;
+        displs[i] *= n_global;
+    }
+    MPI_Allgatherv(A_local.data(), n_local * n_global, MPI_DOUBLE, A.data(), counts.data(), displs.data(),
+                   MPI_DOUBLE, MPI_COMM_WORLD);
+
+    const Eigen::PartialPivLU<Eigen::MatrixXd> A_LU(A);
+    const Eigen::VectorXd x = A_LU.solve(b);
+    const double t_factorize = omp_get_wtime() - st;
+
+    VectorMap(X_->getDataNonConst(0).getRawPtr(), n_local) = x.segment(offset, n_local);
+    n_iterations_ = 0;
+
+    const double b_norm = b.norm();
+    const double residual = (A * x - b).norm() / (b_norm > 0.0 ? b_norm : 1.0);
+    spdlog::info("Direct solver: size {}, assemble {}, gather and factorize {} seconds, relative residual {}", n_global,
+                 t_assemble, t_factorize, residual);
+    return residual <= System::get_params()->gmres_tol;
+}
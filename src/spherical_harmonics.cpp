@@ -0,0 +1,192 @@
+#include <skelly_sim.hpp>
+
+#include <spherical_harmonics.hpp>
+
+#include <cmath>
+
+/// @file
+/// @brief Implement VectorSHT, vector spherical harmonic transforms on a Gauss-Legendre grid
+
+using Eigen::MatrixXcd;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+/// @brief Build the grid and longitude Fourier matrix for maximum degree order
+/// @param[in] order maximum spherical harmonic degree p
+VectorSHT::VectorSHT(int order) : p_(order), n_lat_(order + 1), n_lon_(2 * order + 2) {
+    if (order < 1)
+        throw std::runtime_error("Spherical harmonic order must be at least 1");
+
+    // Gauss-Legendre nodes by Newton iteration on P_n from the usual asymptotic guess
+    cos_theta_.resize(n_lat_);
+    gl_weights_.resize(n_lat_);
+    for (int i = 0; i < n_lat_; ++i) {
+        double t = std::cos(M_PI * (i + 0.75) / (n_lat_ + 0.5));
+        double dP_n = 1.0;
+        for (int iter = 0; iter < 100; ++iter) {
+            double P_prev = 1.0, P_n = t;
+            for (int n = 2; n <= n_lat_; ++n) {
+                const double P_next = ((2 * n - 1) * t * P_n - (n - 1) * P_prev) / n;
+                P_prev = P_n;
+                P_n = P_next;
+            }
+            dP_n = n_lat_ * (t * P_n - P_prev) / (t * t - 1.0);
+            const double dt = P_n / dP_n;
+            t -= dt;
+            if (std::abs(dt) < 1E-15)
+                break;
+        }
+        cos_theta_[i] = t;
+        gl_weights_[i] = 2.0 / ((1.0 - t * t) * dP_n * dP_n);
+    }
+    sin_theta_ = (1.0 - cos_theta_.array().square()).sqrt();
+
+    phi_.resize(n_lon_);
+    fourier_.resize(n_lon_, p_ + 1);
+    for (int k = 0; k < n_lon_; ++k) {
+        phi_[k] = 2.0 * M_PI * k / n_lon_;
+        for (int m = 0; m <= p_; ++m)
+            fourier_(k, m) = std::polar(1.0, -m * phi_[k]);
+    }
+}
+
+/// @brief Grid nodes on the unit sphere, latitude major
+/// @return [3 x N] node positions, which are also the outward normals
+MatrixXd VectorSHT::get_nodes() const {
+    MatrixXd nodes(3, get_n_nodes());
+    for (int j = 0; j < n_lat_; ++j)
+        for (int k = 0; k < n_lon_; ++k)
+            nodes.col(j * n_lon_ + k) << sin_theta_[j] * std::cos(phi_[k]), sin_theta_[j] * std::sin(phi_[k]),
+                cos_theta_[j];
+    return nodes;
+}
+
+/// @brief Quadrature weights on the unit sphere, latitude major
+/// @return [N] weights, summing to \f$4\pi\f$
+VectorXd VectorSHT::get_weights() const {
+    VectorXd weights(get_n_nodes());
+    for (int j = 0; j < n_lat_; ++j)
+        weights.segment(j * n_lon_, n_lon_).setConstant(gl_weights_[j] * 2.0 * M_PI / n_lon_);
+    return weights;
+}
+
+/// @brief Orthonormal associated Legendre functions of order m and their colatitude derivatives at latitude j
+///
+/// \f$\bar{P}_{lm}\f$ is normalized so that \f$\bar{P}_{lm}(\cos\theta) e^{i m \phi}\f$ has unit norm on the sphere.
+/// @param[in] m order
+/// @param[in] j latitude index
+/// @param[out] P [p + 1] \f$\bar{P}_{lm}(\cos\theta_j)\f$ for l = m..p, other entries unset
+/// @param[out] dP [p + 1] \f$\partial_\theta \bar{P}_{lm}(\cos\theta_j)\f$ for l = m..p, other entries unset
+void VectorSHT::legendre(int m, int j, VectorXd &P, VectorXd &dP) const {
+    const double t = cos_theta_[j];
+    const double s = sin_theta_[j];
+    double P_mm = 0.5 / std::sqrt(M_PI);
+    for (int i = 1; i <= m; ++i)
+        P_mm *= std::sqrt((2.0 * i + 1.0) / (2.0 * i)) * s;
+
+    P[m] = P_mm;
+    if (m < p_)
+        P[m + 1] = std::sqrt(2.0 * m + 3.0) * t * P_mm;
+    for (int l = m + 2; l <= p_; ++l) {
+        const double a = std::sqrt((4.0 * l * l - 1.0) / (l * l - m * m));
+        const double b = std::sqrt(((l - 1.0) * (l - 1.0) - m * m) / (4.0 * (l - 1.0) * (l - 1.0) - 1.0));
+        P[l] = a * (t * P[l - 1] - b * P[l - 2]);
+    }
+
+    dP[m] = m * t * P[m] / s;
+    for (int l = m + 1; l <= p_; ++l)
+        dP[l] = (l * t * P[l] - std::sqrt((2.0 * l + 1.0) / (2.0 * l - 1.0) * (l * l - m * m)) * P[l - 1]) / s;
+}
+
+/// @brief Vector spherical harmonic coefficients of a field sampled on the grid
+/// @param[in] f [3 x N] Cartesian field at get_nodes()
+/// @return coefficients of f up to degree p
+VectorSHT::coeffs_t VectorSHT::analyze(MatrixRef &f) const {
+    // Spherical components, one latitude per row, then transform in longitude
+    MatrixXd f_r(n_lat_, n_lon_), f_t(n_lat_, n_lon_), f_p(n_lat_, n_lon_);
+    for (int j = 0; j < n_lat_; ++j) {
+        const double t = cos_theta_[j], s = sin_theta_[j];
+        for (int k = 0; k < n_lon_; ++k) {
+            const double cp = std::cos(phi_[k]), sp = std::sin(phi_[k]);
+            const auto v = f.col(j * n_lon_ + k);
+            f_r(j, k) = s * cp * v[0] + s * sp * v[1] + t * v[2];
+            f_t(j, k) = t * cp * v[0] + t * sp * v[1] - s * v[2];
+            f_p(j, k) = -sp * v[0] + cp * v[1];
+        }
+    }
+    const MatrixXcd F_r = f_r * fourier_;
+    const MatrixXcd F_t = f_t * fourier_;
+    const MatrixXcd F_p = f_p * fourier_;
+
+    coeffs_t coeffs{MatrixXcd::Zero(p_ + 1, p_ + 1), MatrixXcd::Zero(p_ + 1, p_ + 1),
+                    MatrixXcd::Zero(p_ + 1, p_ + 1)};
+    const double dphi = 2.0 * M_PI / n_lon_;
+    const std::complex<double> I(0.0, 1.0);
+#pragma omp parallel
+    {
+        VectorXd P(p_ + 1), dP(p_ + 1);
+#pragma omp for schedule(dynamic)
+        for (int m = 0; m <= p_; ++m) {
+            for (int j = 0; j < n_lat_; ++j) {
+                legendre(m, j, P, dP);
+                const double w = gl_weights_[j] * dphi;
+                const std::complex<double> im_s = I * double(m) / sin_theta_[j];
+                for (int l = m; l <= p_; ++l) {
+                    coeffs.a(l, m) += w * P[l] * F_r(j, m);
+                    coeffs.b(l, m) += w * (dP[l] * F_t(j, m) - im_s * P[l] * F_p(j, m));
+                    coeffs.c(l, m) += w * (dP[l] * F_p(j, m) + im_s * P[l] * F_t(j, m));
+                }
+            }
+        }
+    }
+    for (int l = 1; l <= p_; ++l) {
+        coeffs.b.row(l) /= l * (l + 1.0);
+        coeffs.c.row(l) /= l * (l + 1.0);
+    }
+    coeffs.b.row(0).setZero();
+    coeffs.c.row(0).setZero();
+    return coeffs;
+}
+
+/// @brief Evaluate a vector spherical harmonic expansion on the grid
+/// @param[in] coeffs coefficients, as returned by analyze()
+/// @return [3 x N] Cartesian field at get_nodes()
+MatrixXd VectorSHT::synthesize(const coeffs_t &coeffs) const {
+    MatrixXcd G_r = MatrixXcd::Zero(n_lat_, p_ + 1), G_t = MatrixXcd::Zero(n_lat_, p_ + 1),
+              G_p = MatrixXcd::Zero(n_lat_, p_ + 1);
+    const std::complex<double> I(0.0, 1.0);
+#pragma omp parallel
+    {
+        VectorXd P(p_ + 1), dP(p_ + 1);
+#pragma omp for schedule(dynamic)
+        for (int m = 0; m <= p_; ++m) {
+            for (int j = 0; j < n_lat_; ++j) {
+                legendre(m, j, P, dP);
+                const std::complex<double> im_s = I * double(m) / sin_theta_[j];
+                for (int l = m; l <= p_; ++l) {
+                    G_r(j, m) += coeffs.a(l, m) * P[l];
+                    G_t(j, m) += coeffs.b(l, m) * dP[l] - coeffs.c(l, m) * im_s * P[l];
+                    G_p(j, m) += coeffs.b(l, m) * im_s * P[l] + coeffs.c(l, m) * dP[l];
+                }
+            }
+        }
+    }
+    // Real fields: the m < 0 terms are the conjugates of the m > 0 ones
+    G_r.rightCols(p_) *= 2.0;
+    G_t.rightCols(p_) *= 2.0;
+    G_p.rightCols(p_) *= 2.0;
+    const MatrixXd f_r = (G_r * fourier_.adjoint()).real();
+    const MatrixXd f_t = (G_t * fourier_.adjoint()).real();
+    const MatrixXd f_p = (G_p * fourier_.adjoint()).real();
+
+    MatrixXd f(3, get_n_nodes());
+    for (int j = 0; j < n_lat_; ++j) {
+        const double t = cos_theta_[j], s = sin_theta_[j];
+        for (int k = 0; k < n_lon_; ++k) {
+            const double cp = std::cos(phi_[k]), sp = std::sin(phi_[k]);
+            f.col(j * n_lon_ + k) << s * cp * f_r(j, k) + t * cp * f_t(j, k) - sp * f_p(j, k),
+                s * sp * f_r(j, k) + t * sp * f_t(j, k) + cp * f_p(j, k), t * f_r(j, k) - s * f_t(j, k);
+        }
+    }
+    return f;
+}
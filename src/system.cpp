@@ -3,19 +3,27 @@
 #include <rng.hpp>
 
 #include <Eigen/Core>
+#include <chrono>
+#include <csignal>
 #include <fstream>
+#include <sstream>
 #include <unordered_map>
 
 #include <body.hpp>
+#include <coarse_correction.hpp>
 #include <fiber.hpp>
 #include <params.hpp>
 #include <parse_util.hpp>
 #include <periphery.hpp>
 #include <solver_hydro.hpp>
 #include <system.hpp>
+#include <telemetry.hpp>
+#include <trace.hpp>
+#include <trilinos_preconditioner.hpp>
 
 #include <mpi.h>
 #include <sys/mman.h>
+#include <unistd.h>
 
 #include <spdlog/cfg/env.h>
 #include <spdlog/sinks/null_sink.h>
@@ -28,6 +36,8 @@ FiberContainer fc_;                ///< Fibers
 BodyContainer bc_;                 ///< Bodies
 std::unique_ptr<Periphery> shell_; ///< Periphery
 std::ofstream ofs_;                ///< Trajectory output file stream. Opened at initialization
+CoarseCorrection coarse_;          ///< Optional second level of the preconditioner
+TrilinosPreconditioner ifpack2_;   ///< Optional Ifpack2 replacement of the fiber and body preconditioner blocks
 
 FiberContainer fc_bak_;   ///< Copy of fibers for timestep reversion
 BodyContainer bc_bak_;    ///< Copy of bodies for timestep reversion
@@ -35,11 +45,7 @@ int rank_;                ///< MPI rank
 int size_;                ///< MPI size
 toml::value param_table_; ///< Parsed input table
 
-/// @brief Time varying system properties that are extrinsic to the physical objects
-struct {
-    double dt;         ///< Current timestep size
-    double time = 0.0; ///< Current system time
-} properties;
+Properties properties; ///< Time varying system properties that are extrinsic to the physical objects
 
 /// @brief Structure for trajectory output via msgpack
 ///
@@ -51,10 +57,57 @@ typedef struct output_map_t {
     FiberContainer &fibers = fc_;                            ///< System::fc_
     BodyContainer &bodies = bc_;                             ///< System::bc_
     std::pair<std::string, std::string> rng_state;           ///< string representation of split/unsplit state in RNG
-    MSGPACK_DEFINE_MAP(time, dt, rng_state, fibers, bodies); ///< Helper routine to specify serialization
+    int64_t fiber_params_frame = 0; ///< Frame of this file holding the constant fiber parameters. @see System::write
+    MSGPACK_DEFINE_MAP(time, dt, rng_state, fiber_params_frame, fibers, bodies); ///< Helper routine to specify serialization
 } output_map_t;
 output_map_t output_map; ///< Output data for msgpack dump
 
+/// @brief One set of rank files of a segmented trajectory, as listed in the manifest
+typedef struct {
+    std::string prefix;      ///< Rank files are <prefix>.<rank>
+    int64_t first_frame = 0; ///< Index of the segment's first frame in the whole trajectory
+    int64_t n_frames = 0;    ///< Number of frames in the segment
+    double t_start = 0.0;    ///< Time of the first frame
+    double t_end = 0.0;      ///< Time of the last frame
+} segment_t;
+
+/// @brief Trajectory writer state
+struct {
+    int64_t n_frames = 0;             ///< Frames in the current trajectory file
+    std::vector<double> fiber_params; ///< Constant fiber parameters as last written
+    std::vector<segment_t> segments;  ///< Segments so far, the last being written. Empty unless output is segmented
+} trajectory_;
+
+const std::string manifest_file_ = "skelly_sim.manifest"; ///< Segment list of a segmented trajectory
+
+/// @brief Restart checkpoint bookkeeping. @see System::write_checkpoint
+struct {
+    double start_time = 0.0;    ///< MPI_Wtime at initialization, for the walltime budget
+    double last_write = 0.0;    ///< MPI_Wtime of the last checkpoint
+    double max_step_time = 0.0; ///< Longest wall time of a step so far, as a margin for the walltime budget
+} checkpoint_;
+volatile std::sig_atomic_t stop_signal_ = 0; ///< Signal number requesting a checkpoint and stop, if any
+
+std::unique_ptr<telemetry::Publisher> telemetry_; ///< Live per-step records, if enabled
+StepStats step_stats_; ///< Solver statistics and phase timings of the last step, for telemetry
+
+/// @brief Cheap global quantities, summed in one packed reduction per step and reused until the step ends
+/// @see update_global_scalars
+struct {
+    bool valid = false;           ///< Only set during step()
+    long n_fibers = 0;            ///< Fibers on all ranks
+    long n_attached_fibers = 0;   ///< Fibers bound to a body on all ranks
+    long n_flow_reusable = 0;     ///< Ranks that can reuse the flow of a rejected attempt. @see step
+} globals_;
+
+/// @brief State kept from a rejected step attempt for its retry, which starts from the same geometry. @see restore
+struct {
+    bool retry = false;    ///< Set by run() when the last attempt was rejected
+    Eigen::MatrixXd v_all; ///< Flow on all nodes from fibers and external body forces in the last attempt
+} retry_;
+
+long n_screened_flows_ = 0; ///< Screened fiber flows evaluated at the start of a step. @see report_screening_error
+
 /// @brief Structure for importing frame of trajectory into the simulation
 ///
 /// We can't use output_map_t here, but rather a similar struct which uses copies of the member
@@ -65,20 +118,117 @@ typedef struct input_map_t {
     FiberContainer fibers;                                   ///< System::fc_
     BodyContainer bodies;                                    ///< System::bc_
     std::pair<std::string, std::string> rng_state;           ///< string representation of split/unsplit state in RNG
-    MSGPACK_DEFINE_MAP(time, dt, rng_state, fibers, bodies); ///< Helper routine to specify serialization
+    int64_t fiber_params_frame = -1; ///< Frame holding the constant fiber parameters. -1 for older trajectories
+    MSGPACK_DEFINE_MAP(time, dt, rng_state, fiber_params_frame, fibers, bodies); ///< Helper routine to specify serialization
 } input_map_t;
 
-/// Flush current simulation state to trajectory file.
+/// @brief Is trajectory output split into segments? @see Params::trajectory
+bool segmented_output() { return params_.trajectory.segment_frames > 0 || params_.trajectory.segment_bytes > 0; }
+
+/// @brief Rewrite the segment manifest from rank 0
+///
+/// One line per segment: prefix, first frame, number of frames, first and last time. The file is replaced atomically,
+/// so readers never see a partial manifest.
+void write_manifest() {
+    if (rank_ != 0)
+        return;
+    const std::string tmp_file = manifest_file_ + ".tmp";
+    std::ofstream ofs(tmp_file);
+    ofs.precision(17);
+    ofs << "# skelly_sim manifest\n# prefix first_frame n_frames t_start t_end\n";
+    for (const auto &seg : trajectory_.segments)
+        ofs << seg.prefix << " " << seg.first_frame << " " << seg.n_frames << " " << seg.t_start << " " << seg.t_end
+            << "\n";
+    ofs.close();
+    if (!ofs || std::rename(tmp_file.c_str(), manifest_file_.c_str()))
+        spdlog::warn("Unable to update trajectory manifest {}", manifest_file_);
+}
+
+/// @brief Read the segment manifest, if any
+std::vector<segment_t> read_manifest() {
+    std::vector<segment_t> segments;
+    std::ifstream ifs(manifest_file_);
+    std::string line;
+    while (std::getline(ifs, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream iss(line);
+        segment_t seg;
+        if (!(iss >> seg.prefix >> seg.first_frame >> seg.n_frames >> seg.t_start >> seg.t_end))
+            throw std::runtime_error("Malformed line in " + manifest_file_ + ": " + line);
+        segments.push_back(seg);
+    }
+    return segments;
+}
+
+/// @brief Close the current trajectory file and continue in a new segment
+void open_segment() {
+    segment_t seg;
+    if (!trajectory_.segments.empty())
+        seg.first_frame = trajectory_.segments.back().first_frame + trajectory_.segments.back().n_frames;
+    seg.prefix = fmt::format("skelly_sim.seg{:04d}.out", trajectory_.segments.size());
+    trajectory_.segments.push_back(seg);
+
+    ofs_ = std::ofstream(seg.prefix + "." + std::to_string(rank_), std::ofstream::out | std::ofstream::binary);
+    trajectory_.n_frames = 0;
+    trajectory_.fiber_params.clear();
+    spdlog::info("Writing trajectory segment {}", seg.prefix);
+}
+
+/// @brief Flush current simulation state to trajectory file.
+///
+/// The constant fiber parameters are only written when they differ from the last frame that has them (e.g. after
+/// nucleation or catastrophe), and every frame records which frame of the file that is. With segmented output, a new
+/// segment is started first if the current one has reached its frame or size limit.
 void write() {
+    TRACE_SCOPE("write", "io");
+    if (segmented_output() && trajectory_.n_frames > 0) {
+        const auto &limits = params_.trajectory;
+        bool full = limits.segment_frames > 0 && trajectory_.n_frames >= limits.segment_frames;
+        if (limits.segment_bytes > 0) {
+            long bytes = ofs_.tellp();
+            TRACE_SCOPE("MPI_Allreduce segment size", "mpi");
+            MPI_Allreduce(MPI_IN_PLACE, &bytes, 1, MPI_LONG, MPI_MAX, MPI_COMM_WORLD);
+            full = full || bytes >= limits.segment_bytes;
+        }
+        if (full)
+            open_segment();
+    }
+
+    std::vector<double> fiber_params = fc_.get_constant_params();
+    fc_.with_constant_params_ = trajectory_.n_frames == 0 || fiber_params != trajectory_.fiber_params;
+    if (fc_.with_constant_params_) {
+        output_map.fiber_params_frame = trajectory_.n_frames;
+        trajectory_.fiber_params = std::move(fiber_params);
+    }
+
     output_map.rng_state = RNG::dump_state();
     msgpack::pack(ofs_, output_map);
     ofs_.flush();
+    trajectory_.n_frames++;
+
+    if (segmented_output()) {
+        segment_t &seg = trajectory_.segments.back();
+        if (seg.n_frames++ == 0)
+            seg.t_start = properties.time;
+        seg.t_end = properties.time;
+        write_manifest();
+    }
 }
 
+/// @brief Summary of the trajectory file read by resume_from_trajectory
+typedef struct {
+    std::size_t n_frames; ///< Number of complete frames
+    std::size_t size;     ///< Bytes up to the end of the last complete frame
+    double t_first;       ///< Time of the first frame
+} resume_info_t;
+
 /// @brief Set system state to last state found in trajectory files
 ///
+/// A partially written frame at the end of the file (e.g. from a killed run) is ignored.
 /// @param[in] if_file input file name of trajectory file for this rank
-void resume_from_trajectory(std::string if_file) {
+/// @return frame count, valid size and first time of the file
+resume_info_t resume_from_trajectory(std::string if_file) {
     int fd = open(if_file.c_str(), O_RDONLY);
     if (fd == -1)
         throw std::runtime_error("Unable to open trajectory file " + if_file + " for resume.");
@@ -94,19 +244,43 @@ void resume_from_trajectory(std::string if_file) {
         throw std::runtime_error("Error mapping " + if_file + " for resume.");
 
     std::size_t offset = 0;
+    std::vector<std::size_t> frame_offsets;
     msgpack::object_handle oh;
+    resume_info_t info{0, 0, 0.0};
     // FIXME: There is probably a way to not have to read the entire trajectory
-    while (offset != buflen)
-        msgpack::unpack(oh, addr, buflen, offset);
+    while (offset != buflen) {
+        const std::size_t frame_start = offset;
+        msgpack::object_handle oh_next;
+        try {
+            msgpack::unpack(oh_next, addr, buflen, offset);
+        } catch (msgpack::insufficient_bytes &e) {
+            spdlog::warn("Ignoring truncated frame at end of {}", if_file);
+            break;
+        }
+        oh = std::move(oh_next);
+        if (frame_offsets.empty())
+            info.t_first = oh.get().as<input_map_t>().time;
+        frame_offsets.push_back(frame_start);
+        info.size = offset;
+    }
+    if (frame_offsets.empty())
+        throw std::runtime_error("No complete frames in " + if_file + " to resume from.");
+    info.n_frames = frame_offsets.size();
 
     // FIXME: add assertion that system time is the same across all ranks to resume functionality
 
     // FIXME: This is a bug-prone way to unpack. Should make proper clone functions that merge
     // the minimum representation with existing data automatically (node data, etc)
     msgpack::object obj = oh.get();
-    input_map_t const &min_state = obj.as<input_map_t>();
+    input_map_t min_state = obj.as<input_map_t>();
     output_map.time = min_state.time;
     output_map.dt = min_state.dt;
+    if (!min_state.fibers.with_constant_params_) {
+        msgpack::object_handle oh_params;
+        offset = frame_offsets.at(min_state.fiber_params_frame);
+        msgpack::unpack(oh_params, addr, buflen, offset);
+        min_state.fibers.copy_constant_params(oh_params.get().as<input_map_t>().fibers);
+    }
     fc_.fibers.clear();
     for (const auto &min_fib : min_state.fibers.fibers) {
         Fiber new_fib = min_fib;
@@ -120,6 +294,71 @@ void resume_from_trajectory(std::string if_file) {
     }
     output_map.rng_state = min_state.rng_state;
     RNG::init(output_map.rng_state);
+
+    munmap(const_cast<char *>(addr), buflen);
+    close(fd);
+    return info;
+}
+
+/// @brief Per-rank restart checkpoint file name
+std::string checkpoint_file() { return params_.checkpoint.file + "." + std::to_string(rank_); }
+
+/// @brief Collectively write a restart checkpoint, independent of the trajectory
+///
+/// The checkpoint is a single trajectory frame (with the constant fiber parameters) per rank. Each rank writes a
+/// temporary file, and only once every rank has finished are they renamed into place, so an interrupted checkpoint
+/// leaves the previous one intact.
+void write_checkpoint() {
+    const double st = MPI_Wtime();
+    const std::string filename = checkpoint_file();
+    const std::string tmp_file = filename + ".tmp";
+
+    const int64_t fiber_params_frame = output_map.fiber_params_frame;
+    output_map.fiber_params_frame = 0;
+    fc_.with_constant_params_ = true;
+    output_map.rng_state = RNG::dump_state();
+    std::ofstream ofs(tmp_file, std::ofstream::out | std::ofstream::binary);
+    msgpack::pack(ofs, output_map);
+    ofs.close();
+    output_map.fiber_params_frame = fiber_params_frame;
+
+    int ok = bool(ofs);
+    MPI_Allreduce(MPI_IN_PLACE, &ok, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (!ok)
+        throw std::runtime_error("Unable to write checkpoint " + tmp_file);
+    std::rename(tmp_file.c_str(), filename.c_str());
+    checkpoint_.last_write = MPI_Wtime();
+    spdlog::info("Wrote checkpoint at time {} in {} seconds", properties.time, checkpoint_.last_write - st);
+}
+
+/// @brief After resuming from the trajectory, continue from the checkpoint instead if it is more recent on every rank
+void resume_from_checkpoint() {
+    const std::string filename = checkpoint_file();
+    int newer = 0;
+    if (access(filename.c_str(), R_OK) == 0) {
+        std::ifstream ifs(filename, std::ifstream::binary);
+        const std::string buf((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        try {
+            msgpack::object_handle oh = msgpack::unpack(buf.data(), buf.size());
+            newer = oh.get().as<input_map_t>().time > properties.time;
+        } catch (std::exception &e) {
+            spdlog::warn("Ignoring unreadable checkpoint {}", filename);
+        }
+    }
+    MPI_Allreduce(MPI_IN_PLACE, &newer, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    if (newer) {
+        resume_from_trajectory(filename);
+        spdlog::info("Resumed from checkpoint at time {}", properties.time);
+    }
+}
+
+/// @brief Request a checkpoint and clean stop from the main loop. A second signal terminates immediately.
+extern "C" void handle_stop_signal(int sig) {
+    if (stop_signal_) {
+        std::signal(sig, SIG_DFL);
+        std::raise(sig);
+    }
+    stop_signal_ = sig;
 }
 
 // TODO: Refactor all preprocess stuff. It's awful
@@ -446,9 +685,12 @@ std::pair<Eigen::MatrixXd, Eigen::MatrixXd> calculate_body_fiber_link_conditions
         xt_offset += 4 * n_pts;
     }
 
-    // Sum up fiber contributions from all other ranks to body torques
-    MPI_Allreduce(MPI_IN_PLACE, force_torque_on_bodies.data(), force_torque_on_bodies.size(), MPI_DOUBLE, MPI_SUM,
-                  MPI_COMM_WORLD);
+    // Sum up fiber contributions from all other ranks to body torques, unless no rank has an attached fiber
+    if (!globals_.valid || globals_.n_attached_fibers) {
+        TRACE_SCOPE("MPI_Allreduce link conditions", "mpi");
+        MPI_Allreduce(MPI_IN_PLACE, force_torque_on_bodies.data(), force_torque_on_bodies.size(), MPI_DOUBLE, MPI_SUM,
+                      MPI_COMM_WORLD);
+    }
 
     return std::make_pair(force_torque_on_bodies, velocities_on_fiber);
 }
@@ -464,6 +706,17 @@ std::tuple<int, int, int> get_local_solution_sizes() {
                            bc_.get_local_solution_size());
 }
 
+/// @brief Whether this step solves with Solver::solve_direct, which needs no preconditioner. Collective
+bool use_direct_solve() {
+    const int max_size = params_.direct_solve.max_size;
+    if (max_size <= 0 || params_.imex.enabled)
+        return false;
+    const auto [fib_sol_size, shell_sol_size, body_sol_size] = get_local_solution_sizes();
+    long global_size = fib_sol_size + shell_sol_size + body_sol_size;
+    MPI_Allreduce(MPI_IN_PLACE, &global_size, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+    return global_size <= max_size;
+}
+
 /// @brief Map 1D array data to a three-tuple of Vector Maps [fibers, shell, bodies]
 std::tuple<VectorMap, VectorMap, VectorMap> get_solution_maps(double *x) {
     using Eigen::Map;
@@ -495,12 +748,13 @@ get_node_maps(Eigen::MatrixBase<Derived> &x) {
                            Eigen::Block<Derived>(x.derived(), 0, fib_nodes + shell_nodes, 3, body_nodes));
 }
 
-/// @brief Apply and return preconditioner results from fibers/body/shell
+/// @brief Apply and return block-local preconditioner results from fibers/body/shell
 ///
-/// \f[ P^{-1} * x = y \f]
+/// \f[ P_{\textrm{local}}^{-1} * x = y \f]
 /// @param [in] x [local_solution_size] Vector to apply preconditioner on
+/// @param [in] single_precision use the single precision fiber and shell blocks. @see Solver::solve_mixed_precision
 /// @return [local_solution_size] Preconditioned input vector
-Eigen::VectorXd apply_preconditioner(VectorRef &x) {
+Eigen::VectorXd apply_local_preconditioner(VectorRef &x, bool single_precision = false) {
     const auto [fib_sol_size, shell_sol_size, body_sol_size] = get_local_solution_sizes();
     const int sol_size = fib_sol_size + shell_sol_size + body_sol_size;
     assert(sol_size == x.size());
@@ -509,13 +763,63 @@ Eigen::VectorXd apply_preconditioner(VectorRef &x) {
     auto [x_fibers, x_shell, x_bodies] = get_solution_maps(x.data());
     auto [res_fibers, res_shell, res_bodies] = get_solution_maps(res.data());
 
-    res_fibers = fc_.apply_preconditioner(x_fibers);
-    res_shell = shell_->apply_preconditioner(x_shell);
-    res_bodies = bc_.apply_preconditioner(x_bodies);
+    if (ifpack2_.is_enabled()) {
+        TRACE_SCOPE("precond ifpack2", "precond");
+        Eigen::VectorXd x_local(fib_sol_size + body_sol_size);
+        x_local.head(fib_sol_size) = x_fibers;
+        x_local.tail(body_sol_size) = x_bodies;
+        const Eigen::VectorXd y_local = ifpack2_.apply(x_local);
+        res_fibers = y_local.head(fib_sol_size);
+        res_bodies = y_local.tail(body_sol_size);
+    } else {
+        {
+            TRACE_SCOPE("precond fibers", "precond");
+            res_fibers = fc_.apply_preconditioner(x_fibers, single_precision);
+        }
+        {
+            TRACE_SCOPE("precond bodies", "precond");
+            res_bodies = bc_.apply_preconditioner(x_bodies);
+        }
+    }
+    {
+        TRACE_SCOPE("precond shell", "precond");
+        res_shell = shell_->apply_preconditioner(x_shell, single_precision);
+    }
 
     return res;
 }
 
+/// @brief Apply and return preconditioner results, including the optional coarse correction
+///
+/// Additive: \f[ y = P_{\textrm{local}}^{-1} x + Z c \f]
+/// Multiplicative: \f[ y = Z c + P_{\textrm{local}}^{-1} (x - A Z c) \f]
+/// where \f$ c = (Z^T A Z)^{-1} Z^T x \f$. @see CoarseCorrection
+/// @param [in] x [local_solution_size] Vector to apply preconditioner on
+/// @param [in] single_precision use the single precision fiber and shell blocks. @see Solver::solve_mixed_precision
+/// @return [local_solution_size] Preconditioned input vector
+Eigen::VectorXd apply_preconditioner(VectorRef &x, bool single_precision) {
+    TRACE_SCOPE("preconditioner", "solver");
+    switch (coarse_.get_mode()) {
+    case CoarseCorrection::Additive: {
+        const auto c = [&x] {
+            TRACE_SCOPE("precond coarse", "precond");
+            return coarse_.solve(x);
+        }();
+        return apply_local_preconditioner(x, single_precision) + coarse_.prolong(c);
+    }
+    case CoarseCorrection::Multiplicative: {
+        const auto c = [&x] {
+            TRACE_SCOPE("precond coarse", "precond");
+            return coarse_.solve(x);
+        }();
+        Eigen::VectorXd r = x - coarse_.apply_galerkin(c);
+        return coarse_.prolong(c) + apply_local_preconditioner(r, single_precision);
+    }
+    default:
+        return apply_local_preconditioner(x, single_precision);
+    }
+}
+
 /// @brief Nucleate/grow/destroy Fibers based on dynamic instability rules. See white paper for details
 ///
 /// Modifies:
@@ -524,6 +828,7 @@ Eigen::VectorXd apply_preconditioner(VectorRef &x) {
 /// - Fiber::length_
 /// - Fiber::length_prev_
 void dynamic_instability() {
+    TRACE_SCOPE("dynamic_instability", "step");
     const double dt = properties.dt;
     FiberContainer &fc = fc_;
     BodyContainer &bc = bc_;
@@ -651,7 +956,11 @@ void dynamic_instability() {
 
     for (const auto &min_fib : new_fibers) {
         if (min_fib.rank == rank_) {
-            Fiber fib(params.dynamic_instability.n_nodes, params.dynamic_instability.bending_rigidity, params.eta);
+            // Nucleated fibers are short and straight, so adaptive resolution starts them at the coarsest level
+            const int n_nodes = fc.resolution_policy_.adaptive
+                                    ? fc.select_n_nodes(params.dynamic_instability.min_length, 0.0)
+                                    : params.dynamic_instability.n_nodes;
+            Fiber fib(n_nodes, params.dynamic_instability.bending_rigidity, params.eta);
             fib.length_ = params.dynamic_instability.min_length;
             fib.length_prev_ = params.dynamic_instability.min_length;
             fib.v_growth_ = 0.0;
@@ -677,14 +986,17 @@ void dynamic_instability() {
 ///
 /// \f[ A * x = y \f]
 /// @param [in] x [local_solution_size] Vector to apply matvec on
+/// @param [in] single_precision use the lower order fiber and shell FMMs and the float shell operator. Body terms stay
+/// in double precision. @see Solver::solve_mixed_precision
 /// @return [local_solution_size] Vector y, the result of the operator applied to x.
-Eigen::VectorXd apply_matvec(VectorRef &x) {
+Eigen::VectorXd apply_matvec(VectorRef &x, bool single_precision) {
     using Eigen::Block;
     using Eigen::MatrixXd;
     const FiberContainer &fc = fc_;
     const Periphery &shell = *shell_;
     const BodyContainer &bc = bc_;
     const double eta = params_.eta;
+    TRACE_SCOPE("matvec", "solver");
 
     const auto [fib_node_count, shell_node_count, body_node_count] = get_local_node_counts();
     const int total_node_count = fib_node_count + shell_node_count + body_node_count;
@@ -707,30 +1019,155 @@ Eigen::VectorXd apply_matvec(VectorRef &x) {
     // calculate fiber-fiber velocity
     MatrixXd fw = fc.apply_fiber_force(x_fibers);
     Block<MatrixXd> r_shellbody = r_all.block(0, r_fibers.cols(), 3, r_shell.cols() + r_bodies.cols());
-    MatrixXd v_fib2all = fc.flow(fw, r_shellbody, eta);
+    MatrixXd v_fib2all = fc.flow(fw, r_shellbody, eta, false, single_precision);
 
     MatrixXd r_fibbody(3, r_fibers.cols() + r_bodies.cols());
     r_fibbody.block(0, 0, 3, r_fibers.cols()) = r_fibers;
     r_fibbody.block(0, r_fibers.cols(), 3, r_bodies.cols()) = r_bodies;
-    MatrixXd v_shell2fibbody = shell.flow(r_fibbody, x_shell, eta);
+    MatrixXd v_shell2fibbody = shell.flow(r_fibbody, x_shell, eta, single_precision);
 
-    MatrixXd body_velocities, body_densities, v_fib_boundary, force_torque_bodies;
-    std::tie(body_velocities, body_densities) = bc.unpack_solution_vector(x_bodies);
+    MatrixXd body_velocities, body_densities, body_stresslets, v_fib_boundary, force_torque_bodies;
+    std::tie(body_velocities, body_densities, body_stresslets) = bc.unpack_solution_vector(x_bodies);
     std::tie(force_torque_bodies, v_fib_boundary) =
         System::calculate_body_fiber_link_conditions(x_fibers, body_velocities);
 
     v_all = v_fib2all;
     v_fibers += v_shell2fibbody.block(0, 0, 3, r_fibers.cols());
     v_bodies += v_shell2fibbody.block(0, r_fibers.cols(), 3, r_bodies.cols());
-    v_all += bc.flow(r_all, body_densities, force_torque_bodies, eta);
+    v_all += bc.flow(r_all, body_densities, body_stresslets, force_torque_bodies, eta);
 
     res_fibers = fc.matvec(x_fibers, v_fibers, v_fib_boundary);
-    res_shell = shell.matvec(x_shell, v_shell);
+    res_shell = shell.matvec(x_shell, v_shell, single_precision);
     res_bodies = bc.matvec(v_bodies, body_densities, body_velocities);
 
     return res;
 }
 
+/// @brief Assemble the system state at the start of the step in solution vector layout
+///
+/// Fiber positions are those the step is evaluated at (extrapolated for BDF2), while tensions, shell densities and
+/// body densities/velocities come from the last solve. Anything without a previous solution (new fibers, first step)
+/// is zero.
+/// @return [local_solution_size] lagged solution vector
+Eigen::VectorXd get_lagged_solution() {
+    const auto [fib_sol_size, shell_sol_size, body_sol_size] = get_local_solution_sizes();
+    Eigen::VectorXd x = Eigen::VectorXd::Zero(fib_sol_size + shell_sol_size + body_sol_size);
+    auto [x_fibers, x_shell, x_bodies] = get_solution_maps(x.data());
+
+    size_t offset = 0;
+    for (const auto &fib : fc_.fibers) {
+        const int np = fib.n_nodes_;
+        for (int i = 0; i < 3; ++i)
+            x_fibers.segment(offset + i * np, np) = fib.x_.row(i);
+        if (fib.tension_.size() == np)
+            x_fibers.segment(offset + 3 * np, np) = fib.tension_;
+        offset += 4 * np;
+    }
+
+    if (shell_->solution_vec_.size() == shell_sol_size)
+        x_shell = shell_->solution_vec_;
+
+    offset = 0;
+    if (body_sol_size) {
+        for (const auto &body : bc_.bodies) {
+            const int body_size = body->get_solution_size();
+            if (body->solution_vec_.size() == body_size)
+                x_bodies.segment(offset, body_size) = body->solution_vec_;
+            offset += body_size;
+        }
+    }
+
+    return x;
+}
+
+/// @brief Solve for the next state with local fiber mechanics implicit and all hydrodynamic coupling explicit
+///
+/// One block Jacobi sweep from the lagged state \f$x_0\f$, so every object only needs its own direct solve:
+/// \f[ x = x_0 + P_{\textrm{local}}^{-1} (b - A x_0) \f]
+/// The coupling flows (fiber-fiber, shell, bodies) are evaluated once at \f$x_0\f$. The error indicator is the
+/// relative residual of \f$x\f$ in the fully coupled system, which costs one more matvec.
+/// @param[out] x [local_solution_size] solution vector
+/// @return relative residual \f$ \|b - A x\| / \|b\| \f$
+double solve_imex(Eigen::VectorXd &x) {
+    const auto [fib_sol_size, shell_sol_size, body_sol_size] = get_local_solution_sizes();
+    Eigen::VectorXd RHS(fib_sol_size + shell_sol_size + body_sol_size);
+    RHS << get_fiber_RHS(), get_shell_RHS(), get_body_RHS();
+
+    const Eigen::VectorXd x_lagged = get_lagged_solution();
+    x = x_lagged + apply_local_preconditioner(RHS - apply_matvec(x_lagged));
+
+    double norms[2] = {(RHS - apply_matvec(x)).squaredNorm(), RHS.squaredNorm()};
+    TRACE_SCOPE("MPI_Allreduce IMEX residual", "mpi");
+    MPI_Allreduce(MPI_IN_PLACE, norms, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    return norms[1] > 0.0 ? sqrt(norms[0] / norms[1]) : sqrt(norms[0]);
+}
+
+/// @brief Sum the cheap global quantities used during a step in a single reduction
+///
+/// Until clear_global_scalars(), FiberContainer::get_global_count and the link conditions use these instead of
+/// reducing on every matvec, so fibers must not be added or removed in between.
+/// @param[in] flow_reusable if this rank can reuse the flow of a rejected attempt
+void update_global_scalars(bool flow_reusable) {
+    long n_attached = 0;
+    for (auto &fib : fc_.fibers)
+        n_attached += fib.attached_to_body();
+
+    long sums[3] = {fc_.get_local_count(), n_attached, flow_reusable};
+    {
+        TRACE_SCOPE("MPI_Allreduce global scalars", "mpi");
+        MPI_Allreduce(MPI_IN_PLACE, sums, 3, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+    }
+    globals_ = {true, sums[0], sums[1], sums[2]};
+    fc_.set_global_count(sums[0]);
+}
+
+/// @brief Invalidate the quantities from update_global_scalars, once fibers may change again
+void clear_global_scalars() {
+    globals_.valid = false;
+    fc_.set_global_count(-1);
+}
+
+/// @brief Log the error of the screened fiber flow against the full FMM, and the wall time of each
+///
+/// Errors are over all fiber and external targets on all ranks. Collective.
+/// @param[in] f_on_fibers [ 3 x n_fiber_nodes ] forces the screened flow was computed from
+/// @param[in] r_trg_external [ 3 x n_trg_external ] external targets of the screened flow
+/// @param[in] v_screened [ 3 x (n_fiber_nodes + n_trg_external) ] screened flow
+/// @param[in] t_screened wall time of the screened flow
+void report_screening_error(MatrixRef &f_on_fibers, MatrixRef &r_trg_external, MatrixRef &v_screened,
+                            double t_screened) {
+    TRACE_SCOPE("screening error", "flow");
+    const double st = MPI_Wtime();
+    const Eigen::MatrixXd v_fmm = fc_.flow(f_on_fibers, r_trg_external, params_.eta, true);
+    const double t_fmm = MPI_Wtime() - st;
+
+    const Eigen::MatrixXd error = v_screened - v_fmm;
+    double sums[2] = {error.squaredNorm(), v_fmm.squaredNorm()};
+    double maxs[4] = {error.cols() ? error.colwise().norm().maxCoeff() : 0.0,
+                      v_fmm.cols() ? v_fmm.colwise().norm().maxCoeff() : 0.0, t_screened, t_fmm};
+    {
+        TRACE_SCOPE("MPI_Allreduce screening error", "mpi");
+        MPI_Allreduce(MPI_IN_PLACE, sums, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+        MPI_Allreduce(MPI_IN_PLACE, maxs, 4, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    }
+    spdlog::info("Screened fiber flow vs FMM: relative L2 error {:.3e}, max error {:.3e} at max speed {:.3e}, "
+                 "{:.3g} vs {:.3g} seconds",
+                 sums[1] > 0.0 ? sqrt(sums[0] / sums[1]) : sqrt(sums[0]), maxs[0], maxs[1], maxs[2], maxs[3]);
+}
+
+/// @brief Rotate an orientation by a rotation vector
+/// @param[in] orientation orientation to rotate
+/// @param[in] phi rotation vector, the rotation angle times the unit axis
+/// @return rotated orientation
+Eigen::Quaterniond rotate(const Eigen::Quaterniond &orientation, const Eigen::Vector3d &phi) {
+    const double phi_norm = phi.norm();
+    if (!phi_norm)
+        return orientation;
+    const double s = std::cos(0.5 * phi_norm);
+    const Eigen::Vector3d p = std::sin(0.5 * phi_norm) * phi / phi_norm;
+    return Eigen::Quaterniond(s, p[0], p[1], p[2]) * orientation;
+}
+
 /// @brief Generate next trial system state for the current System::properties::dt
 ///
 /// @note Modifies anything that evolves in time.
@@ -744,55 +1181,127 @@ bool step() {
     const double eta = params.eta;
     const double dt = properties.dt;
 
+    TRACE_SCOPE("step", "step");
+    const double t_start = MPI_Wtime();
     // Since DI can change size of fiber containers, must call first.
     System::dynamic_instability();
 
+    // Variable-step BDF2 is zero-stable for step ratios below 1 + sqrt(2). Larger jumps take a backward Euler step
+    const bool bdf2 = params.time_scheme == "bdf2";
+    const double omega =
+        bdf2 && properties.dt_prev > 0.0 && dt < (1.0 + M_SQRT2) * properties.dt_prev ? dt / properties.dt_prev : 0.0;
+    fc.update_time_history(omega, bdf2);
+
+    // Like the fibers, a BDF2 step evaluates everything lagged at the body poses extrapolated to the end of the step,
+    // while the pose update starts from the pose at the start of the step
+    std::vector<std::pair<Eigen::Vector3d, Eigen::Quaterniond>> body_poses;
+    for (auto &body : bc.bodies) {
+        body_poses.emplace_back(body->position_, body->orientation_);
+        if (omega > 0.0)
+            body->move(body->position_ + omega * body->displacement_prev_,
+                       rotate(body->orientation_, omega * body->rotation_prev_));
+    }
+
     const auto [fib_node_count, shell_node_count, body_node_count] = get_local_node_counts();
+    const bool direct_solve = use_direct_solve();
 
     MatrixXd r_trg_external(3, shell_node_count + body_node_count);
     r_trg_external.block(0, 0, 3, shell_node_count) = shell.get_local_node_positions();
     r_trg_external.block(0, shell_node_count, 3, body_node_count) = bc.get_local_node_positions();
 
-    fc.update_cache_variables(dt, eta);
+    const int n_fibers_rebuilt = fc.update_cache_variables(dt, eta);
+    bc.update_cache_variables(eta, params.body_refresh_interval);
 
-    MatrixXd f_on_fibers = fc.generate_constant_force();
-    MatrixXd v_all = fc.flow(f_on_fibers, r_trg_external, eta);
-
-    bc.update_cache_variables(eta);
+    // Without dynamic instability, which changes fiber lengths with dt, or BDF2 extrapolation, which moves everything
+    // with dt, a retry that kept every fiber's caches sees the same flow as the rejected attempt, so the FMM calls are
+    // skipped
+    const int total_node_count = fib_node_count + shell_node_count + body_node_count;
+    update_global_scalars(retry_.retry && params.dynamic_instability.n_nodes == 0 && omega == 0.0 &&
+                          n_fibers_rebuilt == 0 && retry_.v_all.cols() == total_node_count);
+    const bool same_geometry = retry_.retry && globals_.n_flow_reusable == size_;
 
-    // Check for an add external body forces
-    Eigen::MatrixXd force_torque_bodies = Eigen::MatrixXd::Zero(6, bc.bodies.size());
-    for (size_t i = 0; i < bc.bodies.size(); ++i) {
-        const auto &body = bc.bodies[i];
-        force_torque_bodies.col(i).segment(0, 3) += body->external_force_;
-    }
+    MatrixXd f_on_fibers = fc.generate_constant_force();
+    MatrixXd v_all;
+    if (same_geometry) {
+        v_all = retry_.v_all;
+    } else {
+        const double t_flow_start = MPI_Wtime();
+        v_all = fc.flow(f_on_fibers, r_trg_external, eta);
+        const int check_interval = params.fiber_screening.error_check_interval;
+        if (fc.screened_kernel_ && check_interval > 0 && n_screened_flows_++ % check_interval == 0)
+            report_screening_error(f_on_fibers, r_trg_external, v_all, MPI_Wtime() - t_flow_start);
+
+        // Check for an add external body forces
+        Eigen::MatrixXd force_torque_bodies = Eigen::MatrixXd::Zero(6, bc.bodies.size());
+        for (size_t i = 0; i < bc.bodies.size(); ++i) {
+            const auto &body = bc.bodies[i];
+            force_torque_bodies.col(i).segment(0, 3) += body->external_force_;
+        }
 
-    if (force_torque_bodies.any()) {
-        const int total_node_count = fib_node_count + shell_node_count + body_node_count;
-        MatrixXd r_all(3, total_node_count);
-        auto [r_fibers, r_shell, r_bodies] = get_node_maps(r_all);
-        r_fibers = fc.get_local_node_positions();
-        r_shell = shell.get_local_node_positions();
-        r_bodies = bc.get_local_node_positions();
+        if (force_torque_bodies.any()) {
+            MatrixXd r_all(3, total_node_count);
+            auto [r_fibers, r_shell, r_bodies] = get_node_maps(r_all);
+            r_fibers = fc.get_local_node_positions();
+            r_shell = shell.get_local_node_positions();
+            r_bodies = bc.get_local_node_positions();
 
-        v_all += bc.flow(r_all, Eigen::MatrixXd::Zero(r_bodies.rows(), r_bodies.cols()), force_torque_bodies, eta);
+            v_all += bc.flow(r_all, Eigen::MatrixXd::Zero(r_bodies.rows(), r_bodies.cols()),
+                             Eigen::MatrixXd::Zero(9, bc.get_local_count()), force_torque_bodies, eta);
+        }
+        retry_.v_all = v_all;
     }
 
     bc.update_RHS(v_all.block(0, fib_node_count + shell_node_count, 3, body_node_count));
 
     fc.update_RHS(dt, v_all.block(0, 0, 3, fib_node_count), f_on_fibers);
     fc.update_boundary_conditions(shell, params.periphery_binding_flag);
-    fc.apply_bc_rectangular(dt, v_all.block(0, 0, 3, fib_node_count), f_on_fibers);
+    fc.refactor_policy_.single_precision = params.mixed_precision.enabled;
+    fc.apply_bc_rectangular(dt, v_all.block(0, 0, 3, fib_node_count), f_on_fibers, !direct_solve);
 
     shell.update_RHS(v_all.block(0, fib_node_count, 3, shell_node_count));
+    if (!direct_solve)
+        ifpack2_.update();
+
+    Eigen::VectorXd sol;
+    bool converged = false;
+    bool solved = false;
+    const double t_solve_start = MPI_Wtime();
+    step_stats_.gmres_iterations = 0;
+    step_stats_.imex_residual = 0.0;
+    if (params.imex.enabled) {
+        TRACE_SCOPE("IMEX solve", "solver");
+        const double residual = solve_imex(sol);
+        step_stats_.residual = step_stats_.imex_residual = residual;
+        spdlog::info("IMEX residual: {}", residual);
+        converged = solved = residual <= params.imex.fallback_tol || !params.imex.fallback;
+        if (!solved)
+            spdlog::info("IMEX residual above fallback_tol {}, falling back to full solve", params.imex.fallback_tol);
+        else if (residual > params.imex.fallback_tol)
+            spdlog::warn("IMEX residual above fallback_tol {}", params.imex.fallback_tol);
+    }
 
-    Solver<P_inv_hydro, A_fiber_hydro> solver_;
-    solver_.set_RHS();
-    bool converged = solver_.solve();
-    CVectorMap sol = solver_.get_solution();
+    if (!solved) {
+        TRACE_SCOPE("solve", "solver");
+        Solver<P_inv_hydro, A_fiber_hydro> solver_;
+        solver_.set_RHS();
+        if (direct_solve) {
+            converged = solver_.solve_direct();
+        } else {
+            if (CoarseCorrection::mode_name[coarse_.get_mode()] != params.preconditioner.coarse_correction)
+                coarse_ = CoarseCorrection(params.preconditioner.coarse_correction);
+            coarse_.update();
+            converged = params.mixed_precision.enabled ? solver_.solve_mixed_precision() : solver_.solve();
+        }
+        sol = solver_.get_solution();
 
-    double residual = solver_.get_residual();
-    spdlog::info("Residual: {}", residual);
+        double residual = solver_.get_residual();
+        spdlog::info("Residual: {}", residual);
+        step_stats_.residual = residual;
+        step_stats_.gmres_iterations = solver_.get_n_iterations();
+    }
+    const double t_solve_end = MPI_Wtime();
+    step_stats_.t_setup = t_solve_start - t_start;
+    step_stats_.t_solve = t_solve_end - t_solve_start;
 
     auto [fiber_sol, shell_sol, body_sol] = get_solution_maps(sol.data());
 
@@ -800,11 +1309,20 @@ bool step() {
     for (auto &fib : fc.fibers) {
         for (int i = 0; i < 3; ++i)
             fib.x_.row(i) = sol.segment(offset + i * fib.n_nodes_, fib.n_nodes_);
+        fib.tension_ = sol.segment(offset + 3 * fib.n_nodes_, fib.n_nodes_);
         offset += 4 * fib.n_nodes_;
     }
+    shell.solution_vec_ = shell_sol;
 
-    Eigen::MatrixXd body_velocities, body_densities;
-    std::tie(body_velocities, body_densities) = bc.unpack_solution_vector(body_sol);
+    offset = 0;
+    for (int i = 0; offset < body_sol.size(); ++i) {
+        auto &body = bc.bodies[i];
+        body->solution_vec_ = body_sol.segment(offset, body->get_solution_size());
+        offset += body->solution_vec_.size();
+    }
+
+    Eigen::MatrixXd body_velocities, body_densities, body_stresslets;
+    std::tie(body_velocities, body_densities, body_stresslets) = bc.unpack_solution_vector(body_sol);
     for (int i = 0; i < body_velocities.cols(); ++i) {
         std::stringstream ss;
         ss << body_velocities.col(i).transpose();
@@ -813,15 +1331,24 @@ bool step() {
 
     for (int i = 0; i < bc.bodies.size(); ++i) {
         auto &body = bc.bodies[i];
-        Eigen::Vector3d x_new = body->position_ + body_velocities.col(i).segment(0, 3) * dt;
+        body->velocity_ = body_velocities.col(i).segment(0, 3);
+        body->angular_velocity_ = body_velocities.col(i).segment(3, 3);
+        Eigen::Vector3d displacement = body_velocities.col(i).segment(0, 3) * dt;
         Eigen::Vector3d phi = body_velocities.col(i).segment(3, 3) * dt;
-        double phi_norm = phi.norm();
-        Eigen::Quaterniond orientation_new = body->orientation_;
-        if (phi_norm) {
-            double s = std::cos(0.5 * phi_norm);
-            Eigen::Vector3d p = std::sin(0.5 * phi_norm) * phi / phi_norm;
-            orientation_new = Eigen::Quaterniond(s, p[0], p[1], p[2]) * body->orientation_;
+        if (omega > 0.0) {
+            // BDF2 as an increment on the pose at the start of the step, matching Fiber::update_time_history:
+            // X^{n+1} - X^n = ((1 + w) dt U + w^2 (X^n - X^{n-1})) / (1 + 2w). Rotations compose to second order
+            const double c_now = (1.0 + omega) / (1.0 + 2.0 * omega);
+            const double c_prev = omega * omega / (1.0 + 2.0 * omega);
+            displacement = c_now * displacement + c_prev * body->displacement_prev_;
+            phi = c_now * phi + c_prev * body->rotation_prev_;
         }
+        body->displacement_prev_ = displacement;
+        body->rotation_prev_ = phi;
+
+        const auto &[position, orientation] = body_poses[i];
+        Eigen::Vector3d x_new = position + displacement;
+        Eigen::Quaterniond orientation_new = rotate(orientation, phi);
         std::stringstream ss;
         ss << x_new.transpose();
         spdlog::debug("Moving body {}: [{}]", i, ss.str());
@@ -837,6 +1364,8 @@ bool step() {
             fib.x_.colwise() += delta;
         }
     }
+    step_stats_.t_update = MPI_Wtime() - t_solve_end;
+    clear_global_scalars();
 
     return converged;
 }
@@ -848,9 +1377,18 @@ void backup() {
 }
 
 /// @brief restore copies of Fiber and Body containers to the state when last backed up
+///
+/// The rejected attempt started from the backed up geometry, so its position-only caches are moved into the restored
+/// objects for the retry.
 void restore() {
+    FiberContainer fc_rejected = std::move(fc_);
     fc_ = fc_bak_;
+    fc_.take_geometry_caches(fc_rejected);
+
+    auto bodies_rejected = std::move(bc_.bodies);
     bc_ = bc_bak_;
+    for (size_t i = 0; i < std::min(bc_.bodies.size(), bodies_rejected.size()); ++i)
+        bc_.bodies[i]->take_cache_variables(*bodies_rejected[i]);
 }
 
 /// @brief Run the simulation!
@@ -858,7 +1396,11 @@ void run() {
     Params &params = params_;
 
     System::write();
+    bool stopped = false;
+    uint64_t n_steps = 0;
+    int64_t rss_bytes = 0;
     while (properties.time < params.t_final) {
+        const double step_start = MPI_Wtime();
         System::backup();
         bool converged = System::step();
         double fiber_error = 0.0;
@@ -868,7 +1410,22 @@ void run() {
             for (int i = 0; i < fib.n_nodes_; ++i)
                 fiber_error = std::max(fabs(xs.col(i).norm() - 1.0), fiber_error);
         }
-        MPI_Allreduce(MPI_IN_PLACE, &fiber_error, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+        // Checkpoint requests and collisions ride along with the fiber error reduction, so all ranks agree without
+        // another collective
+        const double now = MPI_Wtime();
+        checkpoint_.max_step_time = std::max(checkpoint_.max_step_time, now - step_start);
+        const auto &cp = params.checkpoint;
+        const bool out_of_time =
+            cp.walltime > 0.0 && now - checkpoint_.start_time + 2.0 * checkpoint_.max_step_time > cp.walltime;
+        const bool checkpoint_due = cp.interval > 0.0 && now - checkpoint_.last_write > cp.interval;
+        double reduce_max[4] = {fiber_error, double(stop_signal_ || out_of_time), double(checkpoint_due),
+                                double(converged && check_local_collision())};
+        {
+            TRACE_SCOPE("MPI_Allreduce step status", "mpi");
+            MPI_Allreduce(MPI_IN_PLACE, reduce_max, 4, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        }
+        fiber_error = reduce_max[0];
 
         double dt_new = properties.dt;
         bool accept = false;
@@ -882,7 +1439,7 @@ void run() {
             accept = false;
         }
 
-        if (converged && System::check_collision()) {
+        if (converged && reduce_max[3]) {
             spdlog::info("Collision detected, rejecting solution and taking a smaller timestep");
             dt_new = properties.dt * 0.5;
             accept = false;
@@ -897,6 +1454,9 @@ void run() {
         if (accept) {
             spdlog::info("Accepting timestep and advancing time");
             properties.time += properties.dt;
+            properties.dt_prev = properties.dt;
+            if (int n_resampled = fc_.update_resolution())
+                spdlog::get("SkellySim global")->info("Resampled {} fibers", n_resampled);
             double &dt_write = params_.dt_write;
             if ((int)(properties.time / dt_write) > (int)((properties.time - properties.dt) / dt_write))
                 System::write();
@@ -904,22 +1464,76 @@ void run() {
             spdlog::info("Rejecting timestep");
             System::restore();
         }
+        retry_.retry = !accept;
+        if (telemetry_) {
+            telemetry::record_t record{};
+            record.step = n_steps++;
+            record.time = properties.time;
+            record.dt = properties.dt;
+            record.wall_time =
+                std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+            record.accepted = accept;
+            record.gmres_iterations = step_stats_.gmres_iterations;
+            record.residual = step_stats_.residual;
+            record.t_step = MPI_Wtime() - step_start;
+            record.t_setup = step_stats_.t_setup;
+            record.t_solve = step_stats_.t_solve;
+            record.t_update = step_stats_.t_update;
+            record.n_fibers = fc_.get_local_count();
+            record.n_fiber_nodes = fc_.get_local_node_count();
+            // Reading /proc costs a system call and a parse, so it is only sampled every rss_interval steps
+            if (record.step % params.telemetry.rss_interval == 0)
+                rss_bytes = telemetry::get_rss_bytes();
+            record.rss_bytes = rss_bytes;
+            telemetry_->publish(record);
+        }
+
         properties.dt = dt_new;
         spdlog::info("System time, dt, fiber_error: {}, {}, {}", properties.time, dt_new, fiber_error);
+
+        if (reduce_max[1] || reduce_max[2])
+            write_checkpoint();
+        if (reduce_max[1]) {
+            spdlog::warn("Stopping at time {} on {}", properties.time, stop_signal_ ? "signal" : "walltime budget");
+            stopped = true;
+            break;
+        }
     }
 
-    System::write();
+    if (!stopped)
+        System::write();
+
+    const auto &stats = FiberContainer::preconditioner_stats_;
+    double counts[3] = {double(stats.n_factorized), double(stats.n_reused), stats.factor_time};
+    MPI_Allreduce(MPI_IN_PLACE, counts, 3, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+    if (counts[0] + counts[1] > 0) {
+        const double t_per_factor = counts[0] ? counts[2] / counts[0] : 0.0;
+        spdlog::info("Fiber preconditioner: {} factorizations, {} reuses ({:.1f}% refactorization rate), "
+                     "{} seconds factoring, ~{} seconds saved",
+                     counts[0], counts[1], 100.0 * counts[0] / (counts[0] + counts[1]), counts[2],
+                     counts[1] * t_per_factor);
+    }
+
+    trace::dump(params.trace.file);
 }
 
-/// @brief Check for any collisions between objects
+/// @brief Check for any collisions between objects on any rank
 bool check_collision() {
+    char collided = check_local_collision();
+    TRACE_SCOPE("MPI_Allreduce collision", "mpi");
+    MPI_Allreduce(MPI_IN_PLACE, &collided, 1, MPI_CHAR, MPI_LOR, MPI_COMM_WORLD);
+    return collided;
+}
+
+/// @brief Check for collisions between objects on this rank
+bool check_local_collision() {
     BodyContainer &bc = bc_;
     FiberContainer &fc = fc_;
     Periphery &shell = *shell_;
     const double threshold = 0.0;
     using Eigen::VectorXd;
 
-    char collided = false;
+    bool collided = false;
     for (const auto &body : bc.bodies)
         if (!collided && body->check_collision(shell, threshold))
             collided = true;
@@ -933,8 +1547,6 @@ bool check_collision() {
             if (!collided && body1 != body2 && body1->check_collision(*body2, threshold))
                 collided = true;
 
-    MPI_Allreduce(MPI_IN_PLACE, &collided, 1, MPI_CHAR, MPI_LOR, MPI_COMM_WORLD);
-
     return collided;
 }
 
@@ -955,6 +1567,9 @@ FiberContainer *get_fiber_container() { return &fc_; }
 Periphery *get_shell() { return shell_.get(); }
 /// @brief get pointer to param table struct
 toml::value *get_param_table() { return &param_table_; }
+const StepStats &get_step_stats() { return step_stats_; }
+/// @brief get pointer to the time varying system properties
+Properties *get_properties() { return &properties; }
 
 /// @brief Initialize entire system. Needs to be called once at the beginning of the program execution
 /// @param[in] input_file String of toml config file specifying system parameters and initial conditions
@@ -962,6 +1577,7 @@ toml::value *get_param_table() { return &param_table_; }
 void init(const std::string &input_file, bool resume_flag) {
     MPI_Comm_rank(MPI_COMM_WORLD, &rank_);
     MPI_Comm_size(MPI_COMM_WORLD, &size_);
+    checkpoint_.start_time = checkpoint_.last_write = MPI_Wtime();
     spdlog::logger sink = rank_ == 0
                               ? spdlog::logger("SkellySim", std::make_shared<spdlog::sinks::ansicolor_stdout_sink_st>())
                               : spdlog::logger("SkellySim", std::make_shared<spdlog::sinks::null_sink_st>());
@@ -973,7 +1589,18 @@ void init(const std::string &input_file, bool resume_flag) {
 
     param_table_ = toml::parse(input_file);
     params_ = Params(param_table_.at("params"));
+    if (params_.time_scheme != "bdf1" && params_.time_scheme != "bdf2")
+        throw std::runtime_error("Unknown time_scheme '" + params_.time_scheme + "'. Valid values are 'bdf1', 'bdf2'");
+    // The IMEX sweep is only as accurate as the local solves it applies, so they must be exact double precision LUs
+    const auto &precond = params_.preconditioner;
+    if (params_.imex.enabled &&
+        (precond.fiber_refactor_geometry_tol > 0.0 || precond.fiber_refactor_length_tol > 0.0 ||
+         precond.fiber_refactor_dt_tol > 0.0 || !precond.ifpack2_type.empty() || params_.mixed_precision.enabled))
+        throw std::runtime_error("imex requires exact fiber factorizations: disable the fiber_refactor tolerances, "
+                                 "ifpack2_type and mixed_precision");
     RNG::init(params_.seed);
+    if (params_.node_shared_operators)
+        Fiber::share_matrices();
     preprocess(param_table_);
 
     if (param_table_.contains("fibers"))
@@ -981,10 +1608,16 @@ void init(const std::string &input_file, bool resume_flag) {
 
     if (param_table_.contains("periphery")) {
         const toml::value &periphery_table = param_table_.at("periphery");
-        if (!params_.shell_precompute_file.length())
+        const bool is_sphere = toml::find_or(periphery_table, "shape", "") == std::string("sphere");
+        // Spherical harmonic operators are built in place and need no precompute data
+        const bool is_spectral = is_sphere && toml::find_or(periphery_table, "representation", "dense") ==
+                                                  std::string("spherical_harmonics");
+        if (!is_spectral && !params_.shell_precompute_file.length())
             throw std::runtime_error("Periphery specified, but no precompute file. Set [params] shell_precompute_file "
                                      "in your input config and run the precompute script.");
-        if (toml::find_or(periphery_table, "shape", "") == std::string("sphere"))
+        if (is_spectral)
+            shell_ = std::make_unique<SphericalPeriphery>(periphery_table, params_);
+        else if (is_sphere)
             shell_ = std::make_unique<SphericalPeriphery>(params_.shell_precompute_file, periphery_table, params_);
         else {
             throw std::runtime_error("Unknown shape for periphery set in input file. Valid values are 'sphere'");
@@ -996,10 +1629,48 @@ void init(const std::string &input_file, bool resume_flag) {
     if (param_table_.contains("bodies"))
         bc_ = BodyContainer(param_table_.at("bodies").as_array(), params_);
     properties.dt = params_.dt_initial;
+    coarse_ = CoarseCorrection(params_.preconditioner.coarse_correction);
+    ifpack2_ = TrilinosPreconditioner(params_.preconditioner.ifpack2_type, params_.preconditioner.ifpack2_parameters);
+
+    if (params_.telemetry.enabled)
+        telemetry_ = std::make_unique<telemetry::Publisher>(params_.telemetry.name, rank_, size_,
+                                                            params_.telemetry.capacity);
+
+    if (params_.trace.enabled)
+        trace::start(params_.trace.max_events);
+
+    if (params_.checkpoint.on_signal) {
+        std::signal(SIGUSR1, handle_stop_signal);
+        std::signal(SIGTERM, handle_stop_signal);
+    }
+
+    if (segmented_output()) {
+        // Resume from the last segment only, then continue in a new one, so a damaged tail is never appended to
+        if (resume_flag) {
+            trajectory_.segments = read_manifest();
+            if (trajectory_.segments.empty())
+                trajectory_.segments.push_back({"skelly_sim.out"});
+            segment_t &seg = trajectory_.segments.back();
+            resume_info_t info = resume_from_trajectory(seg.prefix + "." + std::to_string(rank_));
+            long n_frames = info.n_frames;
+            MPI_Allreduce(MPI_IN_PLACE, &n_frames, 1, MPI_LONG, MPI_MIN, MPI_COMM_WORLD);
+            seg.n_frames = n_frames;
+            seg.t_start = info.t_first;
+            seg.t_end = properties.time;
+            resume_from_checkpoint();
+        }
+        open_segment();
+        return;
+    }
 
     std::string filename = "skelly_sim.out." + std::to_string(rank_);
     if (resume_flag) {
-        resume_from_trajectory(filename);
+        resume_info_t info = resume_from_trajectory(filename);
+        if (truncate(filename.c_str(), info.size))
+            throw std::runtime_error("Unable to truncate " + filename + " to its last complete frame.");
+        // Appended frames continue the numbering. fiber_params stays empty, so the next frame writes the parameters.
+        trajectory_.n_frames = info.n_frames;
+        resume_from_checkpoint();
         ofs_ = std::ofstream(filename, std::ofstream::out | std::ofstream::binary | std::ofstream::app);
     } else {
         ofs_ = std::ofstream(filename, std::ofstream::out | std::ofstream::binary);
@@ -0,0 +1,80 @@
+#include <telemetry.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <spdlog/spdlog.h>
+
+/// @file
+/// @brief Implement the writer side of the shared memory telemetry ring
+
+namespace telemetry {
+
+/// @brief Create (or replace) this rank's shared memory object
+///
+/// Failure is not fatal to the simulation: it is logged and the publisher stays closed.
+Publisher::Publisher(const std::string &name, int rank, int n_ranks, uint32_t capacity)
+    : shm_name_(shm_name(name, rank)) {
+    size_ = sizeof(header_t) + capacity * sizeof(record_t);
+    shm_unlink(shm_name_.c_str());
+    int fd = shm_open(shm_name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd == -1 || ftruncate(fd, size_) == -1) {
+        spdlog::warn("Unable to create telemetry shared memory {}: {}", shm_name_, std::strerror(errno));
+        if (fd != -1)
+            close(fd);
+        return;
+    }
+
+    void *addr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        spdlog::warn("Unable to map telemetry shared memory {}: {}", shm_name_, std::strerror(errno));
+        shm_unlink(shm_name_.c_str());
+        return;
+    }
+
+    header_ = new (addr) header_t;
+    records_ = reinterpret_cast<record_t *>(static_cast<char *>(addr) + sizeof(header_t));
+    header_->record_size = sizeof(record_t);
+    header_->capacity = capacity;
+    header_->rank = rank;
+    header_->n_ranks = n_ranks;
+    header_->pid = getpid();
+    header_->head.store(0, std::memory_order_relaxed);
+    // Readers check the magic last, so they never see a partially initialized header
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, magic, sizeof(magic));
+}
+
+Publisher::~Publisher() {
+    if (!header_)
+        return;
+    munmap(header_, size_);
+    shm_unlink(shm_name_.c_str());
+}
+
+/// @brief Append a record, overwriting the oldest once the ring is full. Wait-free, no system calls.
+void Publisher::publish(record_t record) {
+    if (!header_)
+        return;
+    const uint64_t head = header_->head.load(std::memory_order_relaxed);
+    records_[head % header_->capacity] = record;
+    header_->head.store(head + 1, std::memory_order_release);
+}
+
+/// @brief Resident set size of this process, from /proc/self/statm. 0 if unavailable.
+int64_t get_rss_bytes() {
+    std::ifstream statm("/proc/self/statm");
+    int64_t size = 0, resident = 0;
+    if (!(statm >> size >> resident))
+        return 0;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+} // namespace telemetry
@@ -0,0 +1,140 @@
+#include <trace.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <mpi.h>
+#include <spdlog/spdlog.h>
+
+/// @file
+/// @brief Implement the in-memory event buffers and Chrome trace-event JSON output
+
+namespace trace {
+
+bool enabled_ = false;
+
+namespace {
+struct event_t {
+    const char *name;
+    const char *category;
+    int64_t begin_ns;
+    int64_t end_ns;
+};
+
+/// @brief Events of one thread. Only the owning thread appends, so recording takes no lock
+struct thread_buffer_t {
+    int tid;
+    std::vector<event_t> events;
+    std::size_t n_dropped = 0;
+};
+
+std::chrono::steady_clock::time_point epoch_;
+std::size_t max_events_ = 0;
+std::mutex buffers_mutex_;
+std::vector<std::unique_ptr<thread_buffer_t>> buffers_;
+
+thread_buffer_t &local_buffer() {
+    thread_local thread_buffer_t *buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        buffers_.push_back(std::make_unique<thread_buffer_t>());
+        buffer = buffers_.back().get();
+        buffer->tid = buffers_.size() - 1;
+    }
+    return *buffer;
+}
+} // namespace
+
+void start(std::size_t max_events) {
+    max_events_ = max_events;
+    MPI_Barrier(MPI_COMM_WORLD);
+    epoch_ = std::chrono::steady_clock::now();
+    enabled_ = true;
+}
+
+int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch_).count();
+}
+
+void record(const char *name, const char *category, int64_t begin_ns, int64_t end_ns) {
+    auto &buffer = local_buffer();
+    if (buffer.events.size() < max_events_)
+        buffer.events.push_back({name, category, begin_ns, end_ns});
+    else
+        buffer.n_dropped++;
+}
+
+void dump(const std::string &filename) {
+    if (!enabled_)
+        return;
+    enabled_ = false;
+
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    // Each rank renders its own events, so rank 0 only concatenates
+    std::string json;
+    std::size_t n_events = 0, n_dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mutex_);
+        json += fmt::format(R"({{"name":"process_name","ph":"M","pid":{},"tid":0,"args":{{"name":"rank {}"}}}},)"
+                            "\n",
+                            rank, rank);
+        for (const auto &buffer : buffers_) {
+            json += fmt::format(R"({{"name":"thread_name","ph":"M","pid":{},"tid":{},"args":{{"name":"thread {}"}}}},)"
+                                "\n",
+                                rank, buffer->tid, buffer->tid);
+            for (const auto &e : buffer->events)
+                json += fmt::format(R"({{"name":"{}","cat":"{}","ph":"X","pid":{},"tid":{},"ts":{:.3f},"dur":{:.3f}}},)"
+                                    "\n",
+                                    e.name, e.category, rank, buffer->tid, 1E-3 * e.begin_ns,
+                                    1E-3 * (e.end_ns - e.begin_ns));
+            n_events += buffer->events.size();
+            n_dropped += buffer->n_dropped;
+            buffer->events.clear();
+        }
+    }
+    if (n_dropped)
+        spdlog::warn("Trace buffer full: dropped {} of {} events", n_dropped, n_events + n_dropped);
+
+    // Each rank writes its own events at its offset in the file with MPI-IO, so no rank holds the whole trace and
+    // traces past 2 GiB need no int counts or displacements
+    if (rank == 0)
+        json.insert(0, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    if (rank == size - 1) {
+        // Drop the trailing ",\n" of the last event
+        json.resize(json.size() - 2);
+        json += "\n]}\n";
+    }
+    const long n_chars = json.size();
+    long offset = 0;
+    MPI_Exscan(&n_chars, &offset, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
+    if (rank == 0)
+        offset = 0;
+
+    MPI_File fh;
+    int err = MPI_File_open(MPI_COMM_WORLD, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh);
+    if (err == MPI_SUCCESS) {
+        MPI_File_set_size(fh, 0);
+        const long chunk_size = 1L << 30;
+        for (long pos = 0; pos < n_chars && err == MPI_SUCCESS; pos += chunk_size)
+            err = MPI_File_write_at(fh, offset + pos, json.data() + pos, std::min(chunk_size, n_chars - pos), MPI_CHAR,
+                                    MPI_STATUS_IGNORE);
+        MPI_File_close(&fh);
+    }
+
+    int ok = err == MPI_SUCCESS;
+    MPI_Reduce(rank == 0 ? MPI_IN_PLACE : &ok, &ok, 1, MPI_INT, MPI_MIN, 0, MPI_COMM_WORLD);
+    if (rank == 0) {
+        if (!ok)
+            spdlog::error("Unable to write trace to {}", filename);
+        else
+            spdlog::info("Wrote trace of {} ranks to {}", size, filename);
+    }
+}
+
+} // namespace trace
@@ -0,0 +1,174 @@
+#include <skelly_sim.hpp>
+
+#include <body.hpp>
+#include <fiber.hpp>
+#include <system.hpp>
+#include <trace.hpp>
+#include <trilinos_preconditioner.hpp>
+
+#include <Ifpack2_Factory.hpp>
+#include <Tpetra_Vector.hpp>
+
+#include <omp.h>
+
+#include <spdlog/spdlog.h>
+
+/// @file
+/// @brief Implement TrilinosPreconditioner, the optional Ifpack2 fiber and body preconditioner
+
+namespace {
+/// @brief Copy a TOML table into a Teuchos::ParameterList, recursing into subtables as sublists
+void toml_to_parameter_list(const toml::value &table, Teuchos::ParameterList &list) {
+    for (const auto &[key, value] : table.as_table()) {
+        if (value.is_boolean())
+            list.set(key, value.as_boolean());
+        else if (value.is_integer())
+            list.set(key, static_cast<int>(value.as_integer()));
+        else if (value.is_floating())
+            list.set(key, value.as_floating());
+        else if (value.is_string())
+            list.set(key, std::string(value.as_string()));
+        else if (value.is_table())
+            toml_to_parameter_list(value, list.sublist(key));
+        else
+            throw std::runtime_error("Unsupported type for Ifpack2 parameter '" + key + "'");
+    }
+}
+} // namespace
+
+/// @brief Construct from the configured Ifpack2 preconditioner name and parameter table
+/// @param[in] type Ifpack2 preconditioner name. Empty disables this preconditioner
+/// @param[in] parameters TOML table of Ifpack2 parameters
+TrilinosPreconditioner::TrilinosPreconditioner(const std::string &type, const toml::value &parameters)
+    : type_(type) {
+    if (parameters.is_table())
+        toml_to_parameter_list(parameters, parameters_);
+}
+
+/// @brief Assemble the fiber and body operators and set up the Ifpack2 preconditioner on them
+///
+/// Must be called after the fiber boundary conditions and body operators are updated for the timestep, and before
+/// System::apply_preconditioner. Collective.
+void TrilinosPreconditioner::update() {
+    if (!is_enabled())
+        return;
+
+    const FiberContainer &fc = *System::get_fiber_container();
+    const BodyContainer &bc = *System::get_body_container();
+    const auto [fib_sol_size, shell_sol_size, body_sol_size] = System::get_local_solution_sizes();
+
+    std::vector<Eigen::MatrixXd> body_operators;
+    if (body_sol_size)
+        for (const auto &body : bc.bodies)
+            body_operators.push_back(body->get_operator());
+
+    std::vector<const Eigen::MatrixXd *> blocks;
+    for (const auto &fib : fc.fibers)
+        blocks.push_back(&fib.A_);
+    for (const auto &A_body : body_operators)
+        blocks.push_back(&A_body);
+    update(blocks);
+}
+
+/// @brief Assemble square diagonal blocks, in order, and set up the Ifpack2 preconditioner on them. Collective.
+/// @param[in] blocks this rank's blocks, in solution vector order
+void TrilinosPreconditioner::update(const std::vector<const Eigen::MatrixXd *> &blocks) {
+    if (!is_enabled())
+        return;
+    TRACE_SCOPE("ifpack2 setup", "step");
+
+    if (n_applies_)
+        spdlog::info("Ifpack2 {} apply: {} seconds per call over {} calls", type_, apply_time_ / n_applies_,
+                     n_applies_);
+    apply_time_ = 0.0;
+    n_applies_ = 0;
+
+    double st = omp_get_wtime();
+    size_t max_block = 0, n_rows = 0;
+    for (const auto *block : blocks) {
+        max_block = std::max<size_t>(max_block, block->rows());
+        n_rows += block->rows();
+    }
+
+    map_ = Teuchos::rcp(new Tpetra::Map<>(Teuchos::OrdinalTraits<Tpetra::global_size_t>::invalid(), n_rows, 0,
+                                          Tpetra::getDefaultComm()));
+    A_ = Teuchos::rcp(new matrix_type(map_, max_block));
+
+    // Dense blocks are stored row by row, dropping exact zeros
+    std::vector<GO> cols(max_block);
+    std::vector<double> vals(max_block);
+    auto insert_block = [this, &cols, &vals](const Eigen::MatrixXd &block, GO offset) {
+        for (int i = 0; i < block.rows(); ++i) {
+            int n_entries = 0;
+            for (int j = 0; j < block.cols(); ++j) {
+                if (block(i, j) != 0.0) {
+                    cols[n_entries] = offset + j;
+                    vals[n_entries] = block(i, j);
+                    n_entries++;
+                }
+            }
+            A_->insertGlobalValues(offset + i, n_entries, vals.data(), cols.data());
+        }
+    };
+
+    GO offset = map_->getMinGlobalIndex();
+    for (const auto *block : blocks) {
+        insert_block(*block, offset);
+        offset += block->rows();
+    }
+    A_->fillComplete();
+    const double t_assemble = omp_get_wtime() - st;
+
+    if (map_->getGlobalNumElements() == 0) {
+        prec_ = Teuchos::null;
+        return;
+    }
+
+    // Block relaxation defaults to one part per assembled block
+    Teuchos::ParameterList parameters = parameters_;
+    if (type_ == "BLOCK RELAXATION" && !parameters.isParameter("partitioner: type")) {
+        Teuchos::ArrayRCP<LO> part_of_row = Teuchos::arcp<LO>(n_rows);
+        LO row = 0;
+        for (size_t i_block = 0; i_block < blocks.size(); ++i_block)
+            for (int i = 0; i < blocks[i_block]->rows(); ++i)
+                part_of_row[row++] = i_block;
+        parameters.set("partitioner: type", std::string("user"));
+        parameters.set("partitioner: map", part_of_row);
+        parameters.set("partitioner: local parts", static_cast<LO>(blocks.size()));
+    }
+
+    try {
+        prec_ = Ifpack2::Factory::create<row_matrix_type>(type_, A_);
+        prec_->setParameters(parameters);
+    } catch (const std::exception &e) {
+        throw std::runtime_error("Unable to create Ifpack2 preconditioner '" + type_ + "': " + e.what());
+    }
+
+    st = omp_get_wtime();
+    prec_->initialize();
+    const double t_initialize = omp_get_wtime() - st;
+    st = omp_get_wtime();
+    prec_->compute();
+    const double t_compute = omp_get_wtime() - st;
+
+    spdlog::info("Ifpack2 {} setup: assemble {}, initialize {}, compute {} seconds, {} local nonzeros", type_,
+                 t_assemble, t_initialize, t_compute, A_->getLocalNumEntries());
+}
+
+/// @brief Apply the Ifpack2 preconditioner
+/// @param[in] x [fiber_local_solution_size + body_local_solution_size] fiber then body part of the solution vector
+/// @return preconditioned vector of the same layout
+Eigen::VectorXd TrilinosPreconditioner::apply(VectorRef &x) const {
+    if (prec_.is_null())
+        return x;
+
+    double st = omp_get_wtime();
+    Tpetra::Vector<> X(map_), Y(map_);
+    VectorMap(X.getDataNonConst(0).getRawPtr(), X.getLocalLength()) = x;
+    prec_->apply(X, Y);
+    Eigen::VectorXd y = CVectorMap(Y.getData(0).getRawPtr(), Y.getLocalLength());
+
+    apply_time_ += omp_get_wtime() - st;
+    n_applies_++;
+    return y;
+}
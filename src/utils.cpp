@@ -4,6 +4,10 @@
 
 #include <cnpy.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
 //  Following the paper Calculation of weights in finite different formulas,
 //  Bengt Fornberg, SIAM Rev. 40 (3), 685 (1998).
 //
@@ -106,6 +110,37 @@ Eigen::VectorXd utils::collect_into_global(VectorRef &local_vec) {
     return global_vec;
 }
 
+/// @brief Order points along a Morton (Z-order) space filling curve over their bounding box
+///
+/// Consecutive points in the returned order are spatially close, so contiguous chunks of it make compact partitions.
+/// @param[in] points [3 x n_points] point coordinates
+/// @return [n_points] indices of points in curve order, i.e. order[i] is the original index of the i'th point
+std::vector<int> utils::morton_order(MatrixRef &points) {
+    const int n_points = points.cols();
+    std::vector<int> order(n_points);
+    std::iota(order.begin(), order.end(), 0);
+    if (!n_points)
+        return order;
+
+    // Quantize onto a 2^21 grid per dimension, so the interleaved key fits in 63 bits
+    const int n_bits = 21;
+    const Eigen::Vector3d lo = points.rowwise().minCoeff();
+    const Eigen::Vector3d extent = points.rowwise().maxCoeff() - lo;
+    const double scale = ((1 << n_bits) - 1) / std::max(extent.maxCoeff(), std::numeric_limits<double>::min());
+
+    std::vector<uint64_t> keys(n_points, 0);
+    for (int i = 0; i < n_points; ++i) {
+        for (int dim = 0; dim < 3; ++dim) {
+            const uint64_t coord = (points(dim, i) - lo[dim]) * scale;
+            for (int bit = 0; bit < n_bits; ++bit)
+                keys[i] |= ((coord >> bit) & 1) << (3 * bit + dim);
+        }
+    }
+
+    std::stable_sort(order.begin(), order.end(), [&keys](int a, int b) { return keys[a] < keys[b]; });
+    return order;
+}
+
 Eigen::MatrixXd utils::load_mat(cnpy::npz_t &npz, const char *var) {
     return Eigen::Map<Eigen::ArrayXXd>(npz[var].data<double>(), npz[var].shape[1], npz[var].shape[0]).matrix().transpose();
 }
@@ -113,3 +148,95 @@ Eigen::MatrixXd utils::load_mat(cnpy::npz_t &npz, const char *var) {
 Eigen::VectorXd utils::load_vec(cnpy::npz_t &npz, const char *var) {
     return Eigen::Map<Eigen::VectorXd>(npz[var].data<double>(), npz[var].shape[0]);
 }
+
+/// @brief Communicator of the ranks sharing this rank's compute node (created on first call)
+MPI_Comm utils::get_node_comm() {
+    static MPI_Comm node_comm = MPI_COMM_NULL;
+    if (node_comm == MPI_COMM_NULL)
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &node_comm);
+    return node_comm;
+}
+
+/// @brief Communicator of the node-local rank 0 of every node, ordered by world rank (created on first call)
+///
+/// World rank 0 is always rank 0 of this communicator. Ranks that aren't node leaders get MPI_COMM_NULL.
+MPI_Comm utils::get_node_leader_comm() {
+    static bool initialized = false;
+    static MPI_Comm leader_comm = MPI_COMM_NULL;
+    if (!initialized) {
+        int node_rank, world_rank;
+        MPI_Comm_rank(get_node_comm(), &node_rank);
+        MPI_Comm_rank(MPI_COMM_WORLD, &world_rank);
+        MPI_Comm_split(MPI_COMM_WORLD, node_rank == 0 ? 0 : MPI_UNDEFINED, world_rank, &leader_comm);
+        initialized = true;
+    }
+    return leader_comm;
+}
+
+struct utils::SharedBuffer::window_t {
+    MPI_Win win;
+    ~window_t() {
+        // Buffers can outlive MPI when owned by globals. The OS reclaims the segment then.
+        int finalized;
+        MPI_Finalized(&finalized);
+        if (!finalized) {
+            MPI_Win_unlock_all(win);
+            MPI_Win_free(&win);
+        }
+    }
+};
+
+/// @brief Allocate buffer. Collective over the node communicator if node_shared.
+/// @param[in] size number of doubles
+/// @param[in] node_shared place one copy per node in an MPI-3 shared memory window, rather than one per rank
+utils::SharedBuffer::SharedBuffer(size_t size, bool node_shared) : size_(size) {
+    if (!node_shared) {
+        data_ = std::make_shared<std::vector<double>>(size);
+        ptr_ = data_->data();
+        return;
+    }
+
+    MPI_Comm node_comm = get_node_comm();
+    int node_rank;
+    MPI_Comm_rank(node_comm, &node_rank);
+
+    window_ = std::make_shared<window_t>();
+    const MPI_Aint local_size = node_rank == 0 ? size * sizeof(double) : 0;
+    MPI_Win_allocate_shared(local_size, sizeof(double), MPI_INFO_NULL, node_comm, &ptr_, &window_->win);
+    // Passive target epoch for the window's lifetime, so MPI_Win_sync can order the leader's writes
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, window_->win);
+
+    MPI_Aint segment_size;
+    int disp_unit;
+    MPI_Win_shared_query(window_->win, 0, &segment_size, &disp_unit, &ptr_);
+}
+
+/// @brief True if this rank should fill the buffer (always for private buffers, node leader for shared buffers)
+bool utils::SharedBuffer::is_writer() const {
+    if (!window_)
+        return true;
+    int node_rank;
+    MPI_Comm_rank(get_node_comm(), &node_rank);
+    return node_rank == 0;
+}
+
+/// @brief Copy the buffer contents on world rank 0 to every node (shared) or rank (private), then sync
+///
+/// Collective over MPI_COMM_WORLD. Sent in chunks to avoid overflowing MPI's int counts on large operators.
+void utils::SharedBuffer::broadcast_from_root() {
+    MPI_Comm comm = window_ ? get_node_leader_comm() : MPI_COMM_WORLD;
+    if (comm != MPI_COMM_NULL) {
+        const size_t chunk_size = 1 << 28;
+        for (size_t offset = 0; offset < size_; offset += chunk_size)
+            MPI_Bcast(ptr_ + offset, std::min(chunk_size, size_ - offset), MPI_DOUBLE, 0, comm);
+    }
+    sync();
+}
+
+/// @brief Wait until the node leader has finished writing a shared buffer. No-op for private buffers.
+void utils::SharedBuffer::sync() const {
+    if (window_) {
+        MPI_Win_sync(window_->win);
+        MPI_Barrier(get_node_comm());
+    }
+}
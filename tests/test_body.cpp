@@ -34,6 +34,66 @@ int main(int argc, char *argv[]) {
     toml::array &body_configs = config.at("bodies").as_array();
     Body body(body_configs.at(0).as_table(), params);
 
+    // Rotated reuse of the body operator caches should match a full rebuild
+    {
+        Body body_full = body;
+        Eigen::Quaterniond rot(Eigen::AngleAxisd(0.3, Eigen::Vector3d(1.0, 2.0, 3.0).normalized()));
+        body_full.move(body.position_ + Eigen::Vector3d(0.1, -0.2, 0.3), rot * body.orientation_);
+        Body body_reused = body_full;
+        body_full.update_cache_variables(params.eta);
+        body_reused.update_cache_variables(params.eta, 10);
+        assert(body_reused.refresh_.age == 1);
+        assert(allclose(body_reused.ex_, body_full.ex_, 1E-10, 1E-10));
+        assert(allclose(body_reused.ey_, body_full.ey_, 1E-10, 1E-10));
+        assert(allclose(body_reused.ez_, body_full.ez_, 1E-10, 1E-10));
+        assert(allclose(body_reused.K_, body_full.K_, 1E-10, 1E-10));
+
+        Eigen::VectorXd x = Eigen::VectorXd::Random(3 * body.n_nodes_ + 6);
+        assert(allclose(body_reused.apply_preconditioner(x), body_full.apply_preconditioner(x), 1E-8, 1E-8));
+        assert(allclose(body_reused.get_operator(), body_full.get_operator(), 1E-8, 1E-8));
+        assert(allclose(body_reused.A_, body_full.A_, 1E-8, 1E-8));
+
+        // Updating again at the same pose, as when a rejected step is retried, is a no-op
+        body_reused.update_cache_variables(params.eta, 10);
+        assert(body_reused.refresh_.age == 1);
+
+        // A_ follows the pose through successive rotations between refreshes
+        Eigen::Quaterniond rot2(Eigen::AngleAxisd(-0.5, Eigen::Vector3d(0.0, 1.0, -1.0).normalized()));
+        body_full.move(body_full.position_, rot2 * body_full.orientation_);
+        body_reused.move(body_reused.position_, rot2 * body_reused.orientation_);
+        body_full.update_cache_variables(params.eta);
+        body_reused.update_cache_variables(params.eta, 10);
+        assert(body_reused.refresh_.age == 2);
+        assert(allclose(body_reused.A_, body_full.A_, 1E-8, 1E-8));
+    }
+
+    // Surface moments of a multipole body's own Stokeslet and rotlet are the single sphere mobilities, and its own
+    // stresslet flow returns minus the stresslet, so its operator block is the identity
+    {
+        MultipoleSphericalBody body_mp(body_configs.at(2), params);
+        const double a = body_mp.radius_;
+        const double eta = params.eta;
+        const Eigen::Vector3d F{0.4, -1.1, 0.6};
+        const Eigen::Vector3d T{0.3, 0.8, -0.2};
+        Eigen::MatrixXd v = kernels::oseen_tensor_contract_direct(body_mp.position_, body_mp.node_positions_, F, eta) +
+                            kernels::rotlet(body_mp.position_, body_mp.node_positions_, T, eta);
+        Eigen::VectorXd moments = body_mp.get_moments(v);
+        assert(moments.head(6).norm() < 1E-12);
+        assert(allclose(moments.segment(6, 3), F / (6.0 * M_PI * eta * a), 1E-10, 1E-12));
+        assert(allclose(moments.segment(9, 3), T / (8.0 * M_PI * eta * pow(a, 3)), 1E-10, 1E-12));
+
+        Eigen::VectorXd s(6);
+        s << 0.2, 0.5, -0.7, 0.1, -0.3, 0.4;
+        const Eigen::Matrix3d S = MultipoleSphericalBody::unpack_stresslet(s);
+        for (int i = 0; i < body_mp.n_nodes_; ++i) {
+            const Eigen::Vector3d r = body_mp.node_positions_.col(i) - body_mp.position_;
+            v.col(i) = -3.0 / (8.0 * M_PI * eta) * r * r.dot(S * r) / pow(r.norm(), 5);
+        }
+        moments = body_mp.get_moments(v);
+        assert(allclose(moments.head(6), -s, 1E-10, 1E-12));
+        assert(moments.tail(6).norm() < 1E-12);
+    }
+
     System::init(config_file);
     FiberContainer &fc = *System::get_fiber_container();
     BodyContainer &bc = *System::get_body_container();
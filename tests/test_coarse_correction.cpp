@@ -0,0 +1,95 @@
+#include <skelly_sim.hpp>
+
+#include <iostream>
+#include <mpi.h>
+#include <system.hpp>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#include <cassert>
+#define NDEBUG
+#else
+#include <cassert>
+#endif
+
+#include <coarse_correction.hpp>
+#include <fiber.hpp>
+#include <params.hpp>
+
+/// Replace the fibers with an n_side x n_side bundle of parallel copies of the first fiber, pushed along their
+/// tangents, so that the collective translation of the bundle dominates the hydrodynamic coupling
+void make_bundle(int n_side) {
+    FiberContainer &fc = *System::get_fiber_container();
+    Fiber fib = fc.fibers.front();
+    fib.force_scale_ = 1.0;
+    fib.tension_.setZero();
+    const Eigen::MatrixXd x = fib.x_.colwise() - fib.x_.col(0);
+
+    fc.fibers.clear();
+    const double spacing = 0.1;
+    for (int i = 0; i < n_side; ++i) {
+        for (int j = 0; j < n_side; ++j) {
+            fib.x_ = x.colwise() + Eigen::Vector3d{0.0, i * spacing, j * spacing};
+            fc.fibers.push_back(fib);
+        }
+    }
+}
+
+/// GMRES iterations of one step of a fresh n_side x n_side bundle with the given coarse correction
+int step_iterations(int n_side, const std::string &coarse_correction) {
+    System::get_params()->preconditioner.coarse_correction = coarse_correction;
+    make_bundle(n_side);
+    System::step();
+    return System::get_step_stats().gmres_iterations;
+}
+
+int main(int argc, char *argv[]) {
+    int thread_level;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_level);
+    System::init("test_direct_solve.toml");
+
+    // The Galerkin operator built from the local fiber operators matches Z^T A Z assembled from full matvecs
+    make_bundle(2);
+    System::step();
+    CoarseCorrection coarse("additive");
+    coarse.update();
+
+    const auto [fib_sol_size, shell_sol_size, body_sol_size] = System::get_local_solution_sizes();
+    const int n_coarse = 3 * System::get_fiber_container()->get_local_count();
+    Eigen::MatrixXd Z(fib_sol_size + shell_sol_size + body_sol_size, n_coarse);
+    Eigen::MatrixXd AZ(Z.rows(), n_coarse);
+    Eigen::MatrixXd AZ_galerkin(Z.rows(), n_coarse);
+    for (int j = 0; j < n_coarse; ++j) {
+        CoarseCorrection::coarse_vec_t e{Eigen::VectorXd::Unit(n_coarse, j), Eigen::VectorXd()};
+        Z.col(j) = coarse.prolong(e);
+        AZ.col(j) = System::apply_matvec(Z.col(j));
+        AZ_galerkin.col(j) = coarse.apply_galerkin(e);
+    }
+    assert((AZ_galerkin - AZ).norm() < 1E-10 * AZ.norm());
+
+    const Eigen::MatrixXd ZtAZ = Z.transpose() * AZ;
+    assert((Z.transpose() * AZ_galerkin - ZtAZ).norm() < 1E-10 * ZtAZ.norm());
+
+    // The coarse solve inverts Z^T A Z
+    const Eigen::VectorXd c = Eigen::VectorXd::Random(n_coarse);
+    const Eigen::VectorXd c_solved = coarse.solve(AZ * c).fibers;
+    assert((c_solved - c).norm() < 1E-8 * c.norm());
+
+    // Both coarse corrections save iterations over the local preconditioner alone, and keep the count nearly
+    // independent of the number of fibers
+    const int n_local_small = step_iterations(2, "none");
+    const int n_local_large = step_iterations(4, "none");
+    for (const std::string mode : {"additive", "multiplicative"}) {
+        const int n_small = step_iterations(2, mode);
+        const int n_large = step_iterations(4, mode);
+        std::cout << mode << " iterations: " << n_small << " -> " << n_large << ", local only: " << n_local_small
+                  << " -> " << n_local_large << std::endl;
+        assert(n_small < n_local_small);
+        assert(n_large < n_local_large);
+        assert(n_large - n_small <= std::max(2, n_small / 4));
+    }
+
+    MPI_Finalize();
+    std::cout << "Test passed\n";
+    return 0;
+}
@@ -0,0 +1,55 @@
+#include <skelly_sim.hpp>
+
+#include <iostream>
+#include <mpi.h>
+#include <system.hpp>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#include <cassert>
+#define NDEBUG
+#else
+#include <cassert>
+#endif
+
+#include <fiber.hpp>
+#include <params.hpp>
+
+int main(int argc, char *argv[]) {
+    int thread_level;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_level);
+    System::init("test_direct_solve.toml");
+    Params &params = *System::get_params();
+    assert(params.direct_solve.max_size == 0);
+
+    // Step once with GMRES, then retry the same step with the dense LU of the assembled operator
+    const FiberContainer fc_start = *System::get_fiber_container();
+    System::backup();
+    System::step();
+    const FiberContainer fc_gmres = *System::get_fiber_container();
+    System::restore();
+
+    params.direct_solve.max_size = 1000;
+    const long n_factorized = FiberContainer::preconditioner_stats_.n_factorized;
+    System::step();
+    const FiberContainer &fc_direct = *System::get_fiber_container();
+
+    // The direct step needs no fiber preconditioners
+    assert(FiberContainer::preconditioner_stats_.n_factorized == n_factorized);
+
+    assert(fc_gmres.fibers.size() == fc_direct.fibers.size());
+    auto fib_start = fc_start.fibers.begin();
+    auto fib_gmres = fc_gmres.fibers.begin();
+    for (const auto &fib_direct : fc_direct.fibers) {
+        const Eigen::MatrixXd dx_gmres = fib_gmres->x_ - fib_start->x_;
+        assert(dx_gmres.norm() > 0.0);
+        assert((fib_direct.x_ - fib_gmres->x_).norm() < 1E-6 * dx_gmres.norm());
+        assert((fib_direct.tension_ - fib_gmres->tension_).norm() < 1E-6 * fib_gmres->tension_.norm());
+        ++fib_start;
+        ++fib_gmres;
+    }
+
+    MPI_Finalize();
+    std::cout << "Test passed\n";
+    return 0;
+}
@@ -2,6 +2,7 @@
 
 #include "cnpy.hpp"
 #include <Eigen/Core>
+#include <Eigen/Geometry>
 #include <iostream>
 #include <mpi.h>
 
@@ -127,6 +128,130 @@ int main(int argc, char *argv[]) {
     fib.update_force_operator();
     assert(allclose(force_operator, fib.force_operator_, 0, 1E-7));
 
+    // A lagged factorization is reused for small changes of geometry, length and dt / beta, and refactored beyond the
+    // tolerances
+    {
+        const double tol = 1E-2;
+        Fiber fib_lagged = fib;
+        fib_lagged.update_preconditioner(dt);
+        auto is_current = [tol, dt](const Fiber &f) { return f.preconditioner_is_current(dt, tol, tol, tol); };
+        assert(is_current(fib_lagged));
+
+        for (const double angle : {1E-3, 1E-1}) {
+            Fiber fib_rotated = fib_lagged;
+            fib_rotated.x_ = Eigen::AngleAxisd(angle, Eigen::Vector3d::UnitZ()).toRotationMatrix() * fib_lagged.x_;
+            fib_rotated.update_derivatives();
+            assert(is_current(fib_rotated) == (angle < tol));
+        }
+
+        for (const double rel_change : {1E-3, 1E-1}) {
+            Fiber fib_longer = fib_lagged;
+            fib_longer.length_ *= 1.0 + rel_change;
+            assert(is_current(fib_longer) == (rel_change < tol));
+
+            Fiber fib_dt = fib_lagged;
+            assert(fib_dt.preconditioner_is_current(dt * (1.0 + rel_change), tol, tol, tol) == (rel_change < tol));
+        }
+
+        // Only dt / beta enters the operator, so a BDF2 step with a proportionally longer dt reuses the factorization
+        Fiber fib_bdf2_step = fib_lagged;
+        fib_bdf2_step.beta_tstep_ = 4.0 / 3.0;
+        assert(!is_current(fib_bdf2_step));
+        assert(fib_bdf2_step.preconditioner_is_current(dt * 4.0 / 3.0, tol, tol, tol));
+    }
+
+    // BDF2 falls back to backward Euler without history, and a fiber at rest satisfies beta * X = X_hist for any
+    // step ratio
+    Fiber fib_bdf2 = fib;
+    fib_bdf2.update_time_history(0.5, true);
+    assert(fib_bdf2.beta_tstep_ == 1.0 && fib_bdf2.get_history_positions() == x && fib_bdf2.x_prev_ == x);
+    fib_bdf2.update_time_history(0.5, true);
+    assert(std::abs(fib_bdf2.beta_tstep_ - 4.0 / 3.0) < 1E-14);
+    assert(allclose(fib_bdf2.get_history_positions(), fib_bdf2.beta_tstep_ * x, 0, 1E-12));
+
+    // The step is evaluated at the geometry extrapolated from the last two steps, while the history keeps X^n
+    const Eigen::Vector3d drift{1E-2, -2E-2, 3E-2};
+    fib_bdf2.x_prev_ = x.colwise() - drift;
+    fib_bdf2.update_time_history(0.5, true);
+    assert(allclose(fib_bdf2.x_, x.colwise() + 0.5 * drift, 0, 1E-12) && fib_bdf2.x_prev_ == x);
+
+    // BDF2 is second order in time with the geometry extrapolated to the end of the step: relax a bent fiber on
+    // alternating step sizes and halve the steps. The arc is first relaxed onto the discrete inextensibility
+    // constraint, whose penalty driven transient would otherwise limit both schemes to first order
+    {
+        const double eta_relax = 1.0;
+        Fiber arc(32, 1.0, eta_relax);
+        const double radius = 0.6;
+        arc.length_ = arc.length_prev_ = 1.0;
+        const Eigen::ArrayXd s = 0.5 * (Fiber::matrices_.at(32).alpha + 1.0) * arc.length_ / radius;
+        arc.x_.row(0) = radius * s.sin().matrix().transpose();
+        arc.x_.row(1) = radius * (1.0 - s.cos()).matrix().transpose();
+        arc.x_.row(2).setZero();
+
+        auto relax = [eta_relax](Fiber fib_relax, bool bdf2, double t, int n_steps) {
+            const int np = fib_relax.n_nodes_;
+            const MatrixXd zero = MatrixXd::Zero(3, np);
+            const double h = t / n_steps;
+            double dt_prev = 0.0;
+            for (int i = 0; i < n_steps; ++i) {
+                const double dt_relax = bdf2 ? (i % 2 ? 1.25 : 0.75) * h : h;
+                fib_relax.update_time_history(bdf2 && i > 0 ? dt_relax / dt_prev : 0.0, bdf2);
+                fib_relax.update_derivatives();
+                fib_relax.update_stokeslet(eta_relax);
+                fib_relax.update_linear_operator(dt_relax, eta_relax);
+                fib_relax.update_RHS(dt_relax, zero, zero);
+                fib_relax.apply_bc_rectangular(dt_relax, zero, zero);
+                const VectorXd sol = fib_relax.A_.partialPivLu().solve(fib_relax.RHS_);
+                for (int k = 0; k < 3; ++k)
+                    fib_relax.x_.row(k) = sol.segment(k * np, np);
+                dt_prev = dt_relax;
+            }
+            return fib_relax;
+        };
+        arc = relax(arc, false, 2E-4, 200);
+
+        for (const bool bdf2 : {false, true}) {
+            const MatrixXd x_ref = relax(arc, bdf2, 5E-3, 512).x_;
+            const double ratio = (relax(arc, bdf2, 5E-3, 16).x_ - x_ref).norm() /
+                                 (relax(arc, bdf2, 5E-3, 32).x_ - x_ref).norm();
+            assert(bdf2 ? ratio > 3.5 : ratio < 2.5);
+        }
+    }
+
+    // Test resampling to a finer resolution and back keeps the shape and end points
+    Fiber fib_resampled = fib;
+    fib_resampled.resample(Fiber::supported_n_nodes_.back());
+    assert(fib_resampled.x_.cols() == Fiber::supported_n_nodes_.back());
+    assert(allclose(fib_resampled.x_.col(0), x.col(0), 0, 1E-12));
+    fib_resampled.resample(np);
+    assert(allclose(fib_resampled.x_, x, 0, 1E-2 * length));
+
+    // Resampling carries the tension along, exactly for a linear profile
+    fib_resampled = fib;
+    fib_resampled.tension_ = (2.0 + 3.0 * mat.alpha).matrix();
+    fib_resampled.resample(32);
+    assert(allclose(fib_resampled.tension_, (2.0 + 3.0 * Fiber::matrices_.at(32).alpha).matrix(), 0, 1E-12));
+
+    // Curvature of an accepted circular arc is taken along length_, even while length_prev_ lags behind it
+    {
+        const double radius = 2.0;
+        Fiber arc(32, bending_rigidity, eta);
+        arc.length_ = 1.5;
+        arc.length_prev_ = 1.0;
+        const Eigen::ArrayXd s = 0.5 * (Fiber::matrices_.at(32).alpha + 1.0) * arc.length_ / radius;
+        arc.x_.row(0) = radius * s.cos().matrix().transpose();
+        arc.x_.row(1) = radius * s.sin().matrix().transpose();
+        arc.x_.row(2).setZero();
+        assert(std::abs(arc.max_curvature() * radius - 1.0) < 1E-2);
+    }
+
+    // Short straight fibers get the coarsest resolution, long ones get refined
+    FiberContainer fc;
+    fc.resolution_policy_.max_spacing = length / 10;
+    assert(fc.select_n_nodes(0.5 * length, 0.0) == Fiber::supported_n_nodes_.front());
+    assert(fc.select_n_nodes(length, 0.0) == 16);
+    assert(fc.select_n_nodes(100 * length, 0.0) == fc.resolution_policy_.max_nodes);
+
     std::cout << "Test passed\n";
     return 0;
 }
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <mpi.h>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#include <cassert>
+#define NDEBUG
+#else
+#include <cassert>
+#endif
+
+#include <fiber.hpp>
+#include <params.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+/// Fiber flow from forces that only depend on node positions, so results can be compared across orderings
+Eigen::MatrixXd position_dependent_flow(FiberContainer &fibs, double eta) {
+    const Eigen::MatrixXd r = fibs.get_local_node_positions();
+    Eigen::MatrixXd f(3, r.cols());
+    f.row(0) = (3.0 * r.row(1)).array().sin();
+    f.row(1) = (2.0 * r.row(2)).array().cos();
+    f.row(2) = r.row(0);
+
+    fibs.update_stokeslets(eta);
+    Eigen::MatrixXd r_trg_external;
+    return fibs.flow(f, r_trg_external, eta);
+}
+
+int main(int argc, char *argv[]) {
+    MPI_Init(&argc, &argv);
+    int size;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    spdlog::stdout_color_mt("STKFMM");
+
+    // Fibers are matched locally between orderings, which requires every fiber on one rank
+    assert(size == 1);
+
+    toml::value config = toml::parse("2K_MTs_onCortex_R5_L1.toml");
+    Params params(config.at("params"));
+    toml::array &fiber_tables = config.at("fibers").as_array();
+    assert(params.fiber_ordering == "input" && !params.stkfmm.sort_points);
+
+    FiberContainer fibs(fiber_tables, params);
+    const Eigen::MatrixXd vel = position_dependent_flow(fibs, params.eta);
+
+    // Handing STKFMM its points in Morton order returns the same flow, in the caller's order
+    params.stkfmm.sort_points = true;
+    FiberContainer fibs_sorted_points(fiber_tables, params);
+    const Eigen::MatrixXd vel_sorted_points = position_dependent_flow(fibs_sorted_points, params.eta);
+    assert((vel_sorted_points - vel).norm() < 1E-8 * vel.norm());
+
+    // Morton ordered fibers are a permutation of the input fibers, each with its own flow unchanged
+    params.stkfmm.sort_points = false;
+    params.fiber_ordering = "morton";
+    FiberContainer fibs_morton(fiber_tables, params);
+    const Eigen::MatrixXd vel_morton = position_dependent_flow(fibs_morton, params.eta);
+    assert(fibs_morton.get_local_count() == fibs.get_local_count());
+
+    bool reordered = false;
+    int offset_morton = 0;
+    for (const auto &fib_morton : fibs_morton.fibers) {
+        int offset = 0;
+        bool found = false;
+        for (const auto &fib : fibs.fibers) {
+            if (fib.x_ == fib_morton.x_) {
+                const int np = fib.n_nodes_;
+                const Eigen::MatrixXd dvel = vel_morton.block(0, offset_morton, 3, np) - vel.block(0, offset, 3, np);
+                assert(dvel.norm() < 1E-8 * vel.block(0, offset, 3, np).norm());
+                reordered |= offset != offset_morton;
+                found = true;
+                break;
+            }
+            offset += fib.n_nodes_;
+        }
+        assert(found);
+        offset_morton += fib_morton.n_nodes_;
+    }
+    assert(reordered);
+
+    MPI_Finalize();
+    std::cout << "Test passed\n";
+    return 0;
+}
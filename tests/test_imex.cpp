@@ -0,0 +1,69 @@
+#include <skelly_sim.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <mpi.h>
+#include <system.hpp>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#include <cassert>
+#define NDEBUG
+#else
+#include <cassert>
+#endif
+
+#include <fiber.hpp>
+#include <params.hpp>
+
+int main(int argc, char *argv[]) {
+    int thread_level;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_level);
+    System::init("test_direct_solve.toml");
+    Params &params = *System::get_params();
+    const System::StepStats &stats = System::get_step_stats();
+
+    // Reference step with the full GMRES solve
+    System::backup();
+    System::step();
+    assert(stats.gmres_iterations > 0 && stats.imex_residual == 0.0);
+    const FiberContainer fc_gmres = *System::get_fiber_container();
+    System::restore();
+
+    // An accepted IMEX step reports its coupled residual and needs no GMRES
+    params.imex.enabled = true;
+    params.imex.fallback = true;
+    params.imex.fallback_tol = 1E30;
+    System::step();
+    assert(stats.imex_residual > 0.0 && std::isfinite(stats.imex_residual));
+    assert(stats.residual == stats.imex_residual);
+    assert(stats.gmres_iterations == 0);
+    const double imex_residual = stats.imex_residual;
+    System::restore();
+
+    // Exceeding fallback_tol warns only, unless fallback is set
+    params.imex.fallback_tol = 0.5 * imex_residual;
+    params.imex.fallback = false;
+    System::step();
+    assert(std::abs(stats.imex_residual - imex_residual) < 1E-8 * imex_residual && stats.gmres_iterations == 0);
+    System::restore();
+
+    // With fallback, the step is redone with the full solve and matches the reference
+    params.imex.fallback = true;
+    System::step();
+    assert(std::abs(stats.imex_residual - imex_residual) < 1E-8 * imex_residual);
+    assert(stats.gmres_iterations > 0 && stats.residual < imex_residual);
+
+    const FiberContainer &fc_fallback = *System::get_fiber_container();
+    assert(fc_gmres.fibers.size() == fc_fallback.fibers.size());
+    auto fib_gmres = fc_gmres.fibers.begin();
+    for (const auto &fib_fallback : fc_fallback.fibers) {
+        assert((fib_fallback.x_ - fib_gmres->x_).norm() < 1E-10 * fib_gmres->x_.norm());
+        assert((fib_fallback.tension_ - fib_gmres->tension_).norm() < 1E-8 * fib_gmres->tension_.norm());
+        ++fib_gmres;
+    }
+
+    MPI_Finalize();
+    std::cout << "Test passed\n";
+    return 0;
+}
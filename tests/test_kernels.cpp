@@ -0,0 +1,36 @@
+#include <skelly_sim.hpp>
+
+#include <iostream>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#include <cassert>
+#define NDEBUG
+#else
+#include <cassert>
+#endif
+
+#include <kernels.hpp>
+
+int main(int argc, char *argv[]) {
+    const double eta = 1.3;
+    const Eigen::MatrixXd r_src = Eigen::MatrixXd::Random(3, 2);
+    const Eigen::MatrixXd density = Eigen::MatrixXd::Random(3, 2);
+    const Eigen::MatrixXd r_trg = Eigen::MatrixXd::Random(3, 1) + Eigen::Vector3d(3.0, 0.0, 0.0);
+
+    // Two rotlets at one target give the sum of their single-source velocities
+    const Eigen::MatrixXd u_0 = kernels::rotlet(r_src.col(0), r_trg, density.col(0), eta);
+    const Eigen::MatrixXd u_1 = kernels::rotlet(r_src.col(1), r_trg, density.col(1), eta);
+    const Eigen::MatrixXd u = kernels::rotlet(r_src, r_trg, density, eta);
+    assert(u_0.norm() > 0.0 && u_1.norm() > 0.0);
+    assert((u - (u_0 + u_1)).norm() < 1E-12 * u.norm());
+
+    // Single source: u = (tau x r) / (8 pi eta |r|^3), with r from the source to the target
+    const Eigen::Vector3d r = r_trg.col(0) - r_src.col(0);
+    const Eigen::Vector3d tau = density.col(0);
+    const Eigen::Vector3d u_exact = tau.cross(r) / (8.0 * M_PI * eta * std::pow(r.norm(), 3));
+    assert((u_0.col(0) - u_exact).norm() < 1E-12 * u_exact.norm());
+
+    std::cout << "Test passed\n";
+    return 0;
+}
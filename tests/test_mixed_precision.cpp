@@ -0,0 +1,63 @@
+#include <skelly_sim.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <mpi.h>
+#include <system.hpp>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#include <cassert>
+#define NDEBUG
+#else
+#include <cassert>
+#endif
+
+#include <fiber.hpp>
+#include <params.hpp>
+
+int main(int argc, char *argv[]) {
+    int thread_level;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &thread_level);
+    System::init("test_mixed_precision.toml");
+    Params &params = *System::get_params();
+    const System::StepStats &stats = System::get_step_stats();
+    assert(params.mixed_precision.enabled);
+
+    // Step once with iterative refinement around the low order, single precision inner solves, then retry the same
+    // step with double precision GMRES
+    const FiberContainer fc_start = *System::get_fiber_container();
+    System::backup();
+    System::step();
+    const double t_mixed = stats.t_solve;
+    const double residual_mixed = stats.residual;
+    const FiberContainer fc_mixed = *System::get_fiber_container();
+    System::restore();
+
+    params.mixed_precision.enabled = false;
+    System::step();
+    const double t_gmres = stats.t_solve;
+    const FiberContainer &fc_gmres = *System::get_fiber_container();
+
+    double dx_norm = 0.0, diff_norm = 0.0;
+    assert(fc_mixed.fibers.size() == fc_gmres.fibers.size());
+    auto fib_start = fc_start.fibers.begin();
+    auto fib_mixed = fc_mixed.fibers.begin();
+    for (const auto &fib_gmres : fc_gmres.fibers) {
+        dx_norm += (fib_gmres.x_ - fib_start->x_).squaredNorm();
+        diff_norm += (fib_mixed->x_ - fib_gmres.x_).squaredNorm();
+        assert((fib_mixed->tension_ - fib_gmres.tension_).norm() < 1E-6 * fib_gmres.tension_.norm());
+        ++fib_start;
+        ++fib_mixed;
+    }
+    const double accuracy = std::sqrt(diff_norm / dx_norm);
+    std::cout << "Solve time: mixed precision " << t_mixed << " s, GMRES " << t_gmres << " s. Relative difference of "
+              << "the fiber update: " << accuracy << ", residual " << residual_mixed << std::endl;
+
+    assert(dx_norm > 0.0);
+    assert(accuracy < 1E-6);
+
+    MPI_Finalize();
+    std::cout << "Test passed\n";
+    return 0;
+}
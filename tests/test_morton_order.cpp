@@ -0,0 +1,44 @@
+#include <skelly_sim.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#include <cassert>
+#define NDEBUG
+#else
+#include <cassert>
+#endif
+
+#include <utils.hpp>
+
+int main(int argc, char *argv[]) {
+    // Points on a line, in scrambled order, should come back sorted along the line
+    const int n_line = 100;
+    Eigen::MatrixXd line = Eigen::MatrixXd::Zero(3, n_line);
+    for (int i = 0; i < n_line; ++i)
+        line(0, i) = (37 * i) % n_line;
+
+    std::vector<int> order = utils::morton_order(line);
+    for (int i = 1; i < n_line; ++i)
+        assert(line(0, order[i]) > line(0, order[i - 1]));
+
+    // Result is a permutation, and each half of the curve is one of two well separated clusters
+    const int n_cluster = 64;
+    Eigen::MatrixXd clusters = 0.1 * Eigen::MatrixXd::Random(3, 2 * n_cluster);
+    for (int i = 0; i < 2 * n_cluster; i += 2)
+        clusters.col(i) += Eigen::Vector3d{10.0, 10.0, 10.0};
+
+    order = utils::morton_order(clusters);
+    std::vector<int> sorted = order;
+    std::sort(sorted.begin(), sorted.end());
+    for (int i = 0; i < 2 * n_cluster; ++i)
+        assert(sorted[i] == i);
+
+    for (int i = 0; i < n_cluster; ++i)
+        assert(order[i] % 2 == 1 && order[i + n_cluster] % 2 == 0);
+
+    std::cout << "Test passed\n";
+    return 0;
+}
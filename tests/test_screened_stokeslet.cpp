@@ -0,0 +1,76 @@
+#include <skelly_sim.hpp>
+
+#include <iostream>
+#include <mpi.h>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#include <cassert>
+#define NDEBUG
+#else
+#include <cassert>
+#endif
+
+#include <kernels.hpp>
+#include <screened_stokeslet.hpp>
+
+int main(int argc, char *argv[]) {
+    MPI_Init(&argc, &argv);
+
+    const int n_src = 400;
+    const int n_trg = 300;
+    const double eta = 1.3;
+    const Eigen::MatrixXd r_src = Eigen::MatrixXd::Random(3, n_src);
+    const Eigen::MatrixXd r_trg = Eigen::MatrixXd::Random(3, n_trg);
+    Eigen::MatrixXd density = Eigen::MatrixXd::Random(3, n_src);
+
+    // Sources come in groups of 10, and the first half of the targets belong to one group each
+    std::vector<long> src_group(n_src), trg_group(n_trg, -1);
+    for (int j = 0; j < n_src; ++j)
+        src_group[j] = j / 10;
+    for (int i = 0; i < n_trg / 2; ++i)
+        trg_group[i] = i % (n_src / 10);
+
+    // Every point within the cutoff is a candidate
+    const double cutoff = 0.3;
+    CellList cells(r_src, cutoff);
+    for (int i = 0; i < n_trg; ++i) {
+        std::vector<bool> visited(n_src, false);
+        cells.for_each_candidate(r_trg.col(i), [&visited](int j) { visited[j] = true; });
+        for (int j = 0; j < n_src; ++j)
+            assert(visited[j] || (r_src.col(j) - r_trg.col(i)).norm() > cutoff);
+    }
+
+    // A cutoff beyond the box, without groups, is the plain direct sum
+    ScreenedStokeslet unscreened(10.0, 0.0);
+    const std::vector<long> no_groups(n_trg, -1);
+    const Eigen::MatrixXd v_direct = kernels::oseen_tensor_contract_direct(r_src, r_trg, density, eta);
+    assert((unscreened(r_src, density, src_group, r_trg, no_groups, eta) - v_direct).norm() < 1E-10 * v_direct.norm());
+
+    // Screened sums match a brute force sum, also when a later call only changes the densities
+    ScreenedStokeslet screened(cutoff, 0.5);
+    assert(screened.screening(0.1) == 1.0 && screened.screening(cutoff) == 0.0);
+    assert(std::abs(screened.screening(0.225) - 0.5) < 1E-14);
+    for (int pass = 0; pass < 2; ++pass) {
+        Eigen::MatrixXd v_brute = Eigen::MatrixXd::Zero(3, n_trg);
+        for (int i = 0; i < n_trg; ++i) {
+            for (int j = 0; j < n_src; ++j) {
+                if (trg_group[i] == src_group[j])
+                    continue;
+                const Eigen::Vector3d dx = r_src.col(j) - r_trg.col(i);
+                const double r = dx.norm();
+                const Eigen::Matrix3d G = (Eigen::Matrix3d::Identity() + dx * dx.transpose() / (r * r)) / r;
+                v_brute.col(i) += screened.screening(r) / (8.0 * M_PI * eta) * G * density.col(j);
+            }
+        }
+        const Eigen::MatrixXd v = screened(r_src, density, src_group, r_trg, trg_group, eta);
+        assert((v - v_brute).norm() < 1E-12 * v_brute.norm());
+        assert(screened.get_halo_size() == 0);
+
+        density = Eigen::MatrixXd::Random(3, n_src);
+    }
+
+    MPI_Finalize();
+    std::cout << "Test passed\n";
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <skelly_sim.hpp>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#include <cassert>
+#define NDEBUG
+#else
+#include <cassert>
+#endif
+
+#include <fiber.hpp>
+#include <skelly_traj.h>
+
+/// Mirrors the layout System::write() produces for bodies
+struct body_t {
+    Eigen::Vector3d position_;
+    Eigen::Quaterniond orientation_;
+    MSGPACK_DEFINE_MAP(position_, orientation_);
+};
+
+struct body_container_t {
+    std::vector<body_t> bodies;
+    MSGPACK_DEFINE(bodies);
+};
+
+/// Mirrors System::output_map_t
+struct frame_t {
+    double time;
+    double dt;
+    std::pair<std::string, std::string> rng_state;
+    int64_t fiber_params_frame;
+    FiberContainer fibers;
+    body_container_t bodies;
+    MSGPACK_DEFINE_MAP(time, dt, rng_state, fiber_params_frame, fibers, bodies);
+};
+
+int main(int argc, char *argv[]) {
+    const int n_ranks = 2;
+    const int n_frames = 3;
+    const int n_nodes[n_ranks] = {16, 32};
+
+    for (int rank = 0; rank < n_ranks; ++rank) {
+        std::ofstream ofs("test_traj.out." + std::to_string(rank), std::ofstream::binary);
+        for (int i_frame = 0; i_frame < n_frames; ++i_frame) {
+            // Constant fiber parameters only in the first frame
+            frame_t frame{0.1 * i_frame, 0.1, {"", ""}, 0, {}, {}};
+            frame.fibers.with_constant_params_ = i_frame == 0;
+            for (int i_fib = 0; i_fib <= rank; ++i_fib) {
+                Fiber fib(n_nodes[rank], 0.0025 * (rank + 1), 1.0);
+                fib.x_.row(1).array() = 10 * rank + i_fib;
+                fib.x_.row(2).array() = i_frame;
+                frame.fibers.fibers.push_back(fib);
+            }
+            frame.bodies.bodies.push_back({{1.0, 2.0, 3.0}, Eigen::Quaterniond::Identity()});
+            msgpack::pack(ofs, frame);
+        }
+        // Partially written frame on the last rank, as if the simulation were still running
+        if (rank == n_ranks - 1)
+            ofs.write("\x85\xa4time", 6);
+    }
+
+    for (int pass = 0; pass < 2; ++pass) {
+        // Second pass reads from the cached .idx files
+        skelly_traj_t *traj = skelly_traj_open("test_traj.out");
+        assert(traj);
+        assert(skelly_traj_n_ranks(traj) == n_ranks);
+        assert(skelly_traj_n_frames(traj) == n_frames);
+
+        skelly_traj_frame_t frame;
+        assert(skelly_traj_load_frame(traj, n_frames - 1, &frame) == 0);
+        assert(frame.n_fibers == 3);
+        assert(frame.n_nodes == n_nodes[0] + 2 * n_nodes[1]);
+        assert(frame.fiber_offsets[1] == n_nodes[0] && frame.fiber_offsets[2] == n_nodes[0] + n_nodes[1]);
+        assert(frame.fiber_x[3 * frame.fiber_offsets[2] + 1] == 11.0);
+        assert(frame.fiber_x[3 * frame.fiber_offsets[2] + 2] == n_frames - 1);
+        assert(frame.fiber_x[3 * (frame.n_nodes - 1)] == 1.0);
+        assert(frame.fiber_binding_site[0] == -1);
+        assert(frame.fiber_bending_rigidity[0] == 0.0025 && frame.fiber_bending_rigidity[2] == 0.005);
+        assert(std::abs(frame.time - 0.1 * (n_frames - 1)) < 1E-15);
+        assert(frame.n_bodies == 1 && frame.body_position[2] == 3.0 && frame.body_orientation[0] == 1.0);
+
+        assert(skelly_traj_load_frame(traj, n_frames, &frame) != 0);
+        skelly_traj_close(traj);
+    }
+
+    // Segmented trajectory: the same files listed twice in a manifest
+    {
+        std::ofstream manifest("test_traj.manifest");
+        manifest << "# skelly_sim manifest\n# prefix first_frame n_frames t_start t_end\n"
+                 << "test_traj.out 0 3 0.0 0.2\ntest_traj.out 3 3 0.0 0.2\n";
+    }
+    skelly_traj_t *traj = skelly_traj_open("test_traj.manifest");
+    assert(traj && skelly_traj_n_frames(traj) == 2 * n_frames);
+    skelly_traj_frame_t frame;
+    assert(skelly_traj_load_frame(traj, n_frames + 1, &frame) == 0);
+    assert(frame.n_fibers == 3 && frame.fiber_x[2] == 1.0);
+    skelly_traj_close(traj);
+
+    // Round trip through skelly_convert: one dataset per frame, and every frame's fiber and body points
+    assert(std::system(SKELLY_CONVERT " --prefix test_traj.out --output test_traj_vtk") == 0);
+    auto read_file = [](const std::string &filename) {
+        std::ifstream ifs(filename, std::ifstream::binary);
+        assert(ifs);
+        std::stringstream ss;
+        ss << ifs.rdbuf();
+        return ss.str();
+    };
+    for (const std::string kind : {"fibers", "bodies"}) {
+        const std::string pvd = read_file("test_traj_vtk/" + kind + ".pvd");
+        int n_datasets = 0;
+        for (size_t pos = pvd.find("<DataSet"); pos != std::string::npos; pos = pvd.find("<DataSet", pos + 1))
+            n_datasets++;
+        assert(n_datasets == n_frames);
+    }
+    for (int i_frame = 0; i_frame < n_frames; ++i_frame) {
+        const int n_points = n_nodes[0] + 2 * n_nodes[1];
+        const std::string fibers = read_file("test_traj_vtk/fibers_" + std::to_string(i_frame) + ".vtp");
+        assert(fibers.find("NumberOfPoints=\"" + std::to_string(n_points) + "\" NumberOfLines=\"3\"") !=
+               std::string::npos);
+
+        // The points are the first appended array, after its byte count
+        const std::string appended = "<AppendedData encoding=\"raw\">\n_";
+        const char *points = fibers.data() + fibers.find(appended) + appended.size();
+        uint64_t n_bytes;
+        std::memcpy(&n_bytes, points, sizeof(n_bytes));
+        assert(n_bytes == 3 * n_points * sizeof(double));
+        double z_last;
+        std::memcpy(&z_last, points + sizeof(n_bytes) + n_bytes - sizeof(double), sizeof(double));
+        assert(z_last == i_frame);
+
+        const std::string bodies = read_file("test_traj_vtk/bodies_" + std::to_string(i_frame) + ".vtp");
+        assert(bodies.find("NumberOfPoints=\"1\" NumberOfVerts=\"1\"") != std::string::npos);
+    }
+
+    std::cout << "Test passed\n";
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <skelly_sim.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <mpi.h>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#include <cassert>
+#define NDEBUG
+#else
+#include <cassert>
+#endif
+
+#include <periphery.hpp>
+#include <spherical_harmonics.hpp>
+
+/// @brief Shell operator of the dense representation, by direct singularity-subtracted quadrature on the nodes
+Eigen::MatrixXd apply_dense(const Eigen::MatrixXd &x, const Eigen::VectorXd &w, const Eigen::MatrixXd &density,
+                            double eta) {
+    const int n_nodes = x.cols();
+    const Eigen::MatrixXd normals = -x.colwise().normalized();
+    double n_dot_density = 0.0;
+    for (int j = 0; j < n_nodes; ++j)
+        n_dot_density += w[j] * normals.col(j).dot(density.col(j));
+
+    Eigen::MatrixXd res(3, n_nodes);
+    for (int i = 0; i < n_nodes; ++i) {
+        Eigen::Vector3d u = Eigen::Vector3d::Zero();
+        Eigen::Matrix3d T_sum = Eigen::Matrix3d::Zero();
+        for (int j = 0; j < n_nodes; ++j) {
+            if (i == j)
+                continue;
+            const Eigen::Vector3d r = x.col(i) - x.col(j);
+            const double r_norm = r.norm();
+            const Eigen::Matrix3d T =
+                (-3.0 / (4.0 * M_PI * eta) * r.dot(normals.col(j)) / std::pow(r_norm, 5)) * r * r.transpose();
+            u += w[j] * T * density.col(j);
+            T_sum += w[j] * T;
+        }
+        res.col(i) = u - T_sum * density.col(i) - density.col(i) + normals.col(i) * n_dot_density;
+    }
+    return res;
+}
+
+int main(int argc, char *argv[]) {
+    MPI_Init(&argc, &argv);
+    const int order = 12;
+    VectorSHT sht(order);
+    assert(std::abs(sht.get_weights().sum() - 4.0 * M_PI) < 1E-12);
+
+    // Band limited fields survive a round trip
+    VectorSHT::coeffs_t coeffs{Eigen::MatrixXcd::Zero(order + 1, order + 1),
+                               Eigen::MatrixXcd::Zero(order + 1, order + 1),
+                               Eigen::MatrixXcd::Zero(order + 1, order + 1)};
+    for (int l = 0; l <= order; ++l) {
+        for (int m = 0; m <= l; ++m) {
+            coeffs.a(l, m) = std::complex<double>(std::rand(), m ? std::rand() : 0) / double(RAND_MAX);
+            if (l > 0) {
+                coeffs.b(l, m) = std::complex<double>(std::rand(), m ? std::rand() : 0) / double(RAND_MAX);
+                coeffs.c(l, m) = std::complex<double>(std::rand(), m ? std::rand() : 0) / double(RAND_MAX);
+            }
+        }
+    }
+    const Eigen::MatrixXd field = sht.synthesize(coeffs);
+    const VectorSHT::coeffs_t roundtrip = sht.analyze(field);
+    assert((roundtrip.a - coeffs.a).norm() < 1E-10 * coeffs.a.norm());
+    assert((roundtrip.b - coeffs.b).norm() < 1E-10 * coeffs.b.norm());
+    assert((roundtrip.c - coeffs.c).norm() < 1E-10 * coeffs.c.norm());
+    assert((sht.synthesize(roundtrip) - field).norm() < 1E-10 * field.norm());
+
+    // Per-degree blocks match the operator assembled from the kernel on the same grid
+    const double eta = 2.5;
+    const double node_radius = 3.0 * SphericalPeriphery::node_scale_factor;
+    const Eigen::MatrixXd x = node_radius * sht.get_nodes();
+    const Eigen::VectorXd w = node_radius * node_radius * sht.get_weights();
+    for (int l = 0; l <= 3; ++l) {
+        const Eigen::Matrix2d poloidal = SphericalPeriphery::get_poloidal_block(l, eta, node_radius);
+        for (int component = 0; component < 3; ++component) {
+            if (l == 0 && component > 0)
+                continue;
+            VectorSHT::coeffs_t mode{Eigen::MatrixXcd::Zero(order + 1, order + 1),
+                                     Eigen::MatrixXcd::Zero(order + 1, order + 1),
+                                     Eigen::MatrixXcd::Zero(order + 1, order + 1)};
+            (component == 0 ? mode.a : component == 1 ? mode.b : mode.c)(l, 0) = 1.0;
+            const VectorSHT::coeffs_t res = sht.analyze(apply_dense(x, w, sht.synthesize(mode), eta));
+
+            Eigen::Vector3d expected = Eigen::Vector3d::Zero();
+            if (component < 2)
+                expected.head<2>() = poloidal.col(component);
+            else
+                expected[2] = SphericalPeriphery::get_toroidal_eigenvalue(l, eta);
+            if (l == 0)
+                expected[1] = 0.0;
+
+            const Eigen::Vector3d actual{res.a(l, 0).real(), res.b(l, 0).real(), res.c(l, 0).real()};
+            assert((actual - expected).norm() < 2E-3 * (1.0 + expected.norm()));
+        }
+    }
+
+    // At eta = 0.5 the operator vanishes on the unresolved degrees, so it has no inverse
+    toml::value periphery_table = toml::table{{"radius", 3.0}, {"sh_order", order}};
+    for (const double eta_shell : {2.5, 0.5}) {
+        toml::value param_table = toml::table{{"eta", eta_shell}};
+        Params params(param_table);
+        bool singular = false;
+        try {
+            SphericalPeriphery shell(periphery_table, params);
+        } catch (const std::runtime_error &) {
+            singular = true;
+        }
+        assert(singular == (eta_shell == 0.5));
+    }
+
+    MPI_Finalize();
+    std::cout << "Test passed\n";
+    return 0;
+}
@@ -0,0 +1,98 @@
+#include <skelly_sim.hpp>
+
+#include "cnpy.hpp"
+#include <Eigen/Dense>
+#include <iostream>
+#include <mpi.h>
+
+#ifdef NDEBUG
+#undef NDEBUG
+#include <cassert>
+#define NDEBUG
+#else
+#include <cassert>
+#endif
+
+#include <body.hpp>
+#include <fiber.hpp>
+#include <params.hpp>
+#include <trilinos_preconditioner.hpp>
+
+using Eigen::Map;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+MatrixXd load_mat(cnpy::npz_t &npz, const char *var) {
+    return Map<Eigen::ArrayXXd>(npz[var].data<double>(), npz[var].shape[1], npz[var].shape[0]).matrix();
+}
+
+int main(int argc, char *argv[]) {
+    MPI_Init(&argc, &argv);
+
+    // Fiber operator with boundary conditions, as in test_fiber
+    cnpy::npz_t np_fib = cnpy::npz_load("np_fib.npz");
+    const MatrixXd x = load_mat(np_fib, "x");
+    const MatrixXd force_external = load_mat(np_fib, "force_external");
+    const MatrixXd flow_on = load_mat(np_fib, "flow_on");
+    const double bending_rigidity = *np_fib["bending_rigidity"].data<double>();
+    const double length = *np_fib["length"].data<double>();
+    const double eta = *np_fib["eta"].data<double>();
+    const double dt = *np_fib["dt"].data<double>();
+
+    Fiber fib(x.cols(), bending_rigidity, eta);
+    fib.length_ = length;
+    fib.length_prev_ = length;
+    fib.x_ = x;
+    fib.update_derivatives();
+    fib.update_stokeslet(eta);
+    fib.update_linear_operator(dt, eta);
+    fib.bc_minus_ = {Fiber::BC::Velocity, Fiber::BC::AngularVelocity};
+    fib.bc_plus_ = {Fiber::BC::Force, Fiber::BC::Torque};
+    fib.apply_bc_rectangular(dt, flow_on, force_external);
+
+    // Body operators
+    toml::value config = toml::parse("test_body.toml");
+    Params params(config.at("params"));
+    toml::array &body_configs = config.at("bodies").as_array();
+    Body body(body_configs.at(0).as_table(), params);
+    Body body2(body_configs.at(1).as_table(), params);
+    const MatrixXd A_body = body.get_operator();
+    const MatrixXd A_body2 = body2.get_operator();
+
+    // Applying the preconditioner matches the exact LU solve of each block
+    auto check_exact = [](TrilinosPreconditioner &prec, const std::vector<const MatrixXd *> &blocks) {
+        long n_rows = 0;
+        for (const auto *block : blocks)
+            n_rows += block->rows();
+
+        // Setting up again, as every timestep does, replaces the previous factorization
+        for (int pass = 0; pass < 2; ++pass) {
+            prec.update(blocks);
+
+            const VectorXd rhs = VectorXd::Random(n_rows);
+            const VectorXd y = prec.apply(rhs);
+            VectorXd y_exact(n_rows);
+            long offset = 0;
+            for (const auto *block : blocks) {
+                const long n = block->rows();
+                y_exact.segment(offset, n) = block->partialPivLu().solve(rhs.segment(offset, n));
+                offset += n;
+            }
+            assert((y - y_exact).norm() < 1E-6 * y_exact.norm());
+        }
+    };
+    assert(!TrilinosPreconditioner().is_enabled());
+
+    // Level-of-fill beyond the block size fills the dense body blocks completely, so RILUK is their exact LU. Fibers
+    // need pivoting, which RILUK lacks
+    TrilinosPreconditioner riluk("RILUK", toml::table{{"fact: iluk level-of-fill", 1000}});
+    check_exact(riluk, {&A_body, &A_body2});
+
+    // Block relaxation with dense containers, one part per block by default, is exact for fibers too
+    TrilinosPreconditioner block_relaxation("BLOCK RELAXATION", toml::table{{"relaxation: container", "Dense"}});
+    check_exact(block_relaxation, {&fib.A_, &A_body, &fib.A_, &A_body2});
+
+    MPI_Finalize();
+    std::cout << "Test passed\n";
+    return 0;
+}
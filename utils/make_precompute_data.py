@@ -29,6 +29,9 @@ periphery_node_scale_factor = 1.04
 def precompute_periphery(config):
     if 'periphery' not in config:
         return
+    if config['periphery'].get('representation', 'dense') == 'spherical_harmonics':
+        print("Spherical harmonic periphery builds its operators at startup, skipping precompute")
+        return
     shell_precompute_file = config['params']['shell_precompute_file']
     periphery_type = config['periphery']['shape']
     n_periphery = config['periphery']['n_nodes']
@@ -171,6 +174,9 @@ def precompute_body(config, body):
 visited_precomputes = []
 if "bodies" in config:
     for body in config["bodies"]:
+        # Multipole bodies build their nodes at startup
+        if body.get('representation', 'surface') == 'multipole':
+            continue
         if body['precompute_file'] not in visited_precomputes:
             visited_precomputes.append(body['precompute_file'])
             print(body)
@@ -0,0 +1,98 @@
+"""ctypes bindings for libskelly_traj (include/skelly_traj.h)
+
+Example:
+    traj = SkellyTrajectory("skelly_sim.out")
+    frame = traj.load_frame(len(traj) - 1)
+    fiber_0 = frame["fiber_x"][frame["fiber_offsets"][0]:frame["fiber_offsets"][1]]
+
+Arrays in a frame are views into library memory, valid until the next load_frame() or close().
+Set SKELLY_TRAJ_LIB to the path of libskelly_traj.so if it isn't on the loader path.
+"""
+
+import ctypes
+import os
+
+import numpy as np
+
+_i32p = ctypes.POINTER(ctypes.c_int32)
+_i64p = ctypes.POINTER(ctypes.c_int64)
+_f64p = ctypes.POINTER(ctypes.c_double)
+
+
+class _Frame(ctypes.Structure):
+    _fields_ = [
+        ("time", ctypes.c_double),
+        ("dt", ctypes.c_double),
+        ("n_fibers", ctypes.c_int64),
+        ("n_nodes", ctypes.c_int64),
+        ("fiber_n_nodes", _i32p),
+        ("fiber_offsets", _i64p),
+        ("fiber_length", _f64p),
+        ("fiber_bending_rigidity", _f64p),
+        ("fiber_binding_site", _i32p),
+        ("fiber_x", _f64p),
+        ("n_bodies", ctypes.c_int64),
+        ("body_position", _f64p),
+        ("body_orientation", _f64p),
+    ]
+
+
+def _load_library():
+    lib = ctypes.CDLL(os.environ.get("SKELLY_TRAJ_LIB", "libskelly_traj.so"))
+    lib.skelly_traj_open.restype = ctypes.c_void_p
+    lib.skelly_traj_open.argtypes = [ctypes.c_char_p]
+    lib.skelly_traj_close.argtypes = [ctypes.c_void_p]
+    lib.skelly_traj_n_frames.restype = ctypes.c_int64
+    lib.skelly_traj_n_frames.argtypes = [ctypes.c_void_p]
+    lib.skelly_traj_n_ranks.restype = ctypes.c_int64
+    lib.skelly_traj_n_ranks.argtypes = [ctypes.c_void_p]
+    lib.skelly_traj_load_frame.restype = ctypes.c_int
+    lib.skelly_traj_load_frame.argtypes = [ctypes.c_void_p, ctypes.c_int64, ctypes.POINTER(_Frame)]
+    lib.skelly_traj_last_error.restype = ctypes.c_char_p
+    return lib
+
+
+def _view(ptr, shape):
+    if np.prod(shape) == 0:
+        return np.zeros(shape, dtype=np.dtype(ptr._type_))
+    return np.ctypeslib.as_array(ptr, shape=shape)
+
+
+class SkellyTrajectory:
+    _lib = None
+
+    def __init__(self, prefix="skelly_sim.out"):
+        if SkellyTrajectory._lib is None:
+            SkellyTrajectory._lib = _load_library()
+        self._handle = self._lib.skelly_traj_open(prefix.encode())
+        if not self._handle:
+            raise IOError(self._lib.skelly_traj_last_error().decode())
+
+    def __len__(self):
+        return self._lib.skelly_traj_n_frames(self._handle)
+
+    def close(self):
+        if self._handle:
+            self._lib.skelly_traj_close(self._handle)
+            self._handle = None
+
+    def __del__(self):
+        self.close()
+
+    def load_frame(self, index):
+        f = _Frame()
+        if self._lib.skelly_traj_load_frame(self._handle, index, ctypes.byref(f)):
+            raise IndexError(self._lib.skelly_traj_last_error().decode())
+
+        return {
+            "time": f.time,
+            "dt": f.dt,
+            "fiber_n_nodes": _view(f.fiber_n_nodes, (f.n_fibers,)),
+            "fiber_offsets": _view(f.fiber_offsets, (f.n_fibers + 1,)),
+            "fiber_length": _view(f.fiber_length, (f.n_fibers,)),
+            "fiber_bending_rigidity": _view(f.fiber_bending_rigidity, (f.n_fibers,)),
+            "fiber_binding_site": _view(f.fiber_binding_site, (f.n_fibers, 2)),
+            "fiber_x": _view(f.fiber_x, (f.n_nodes, 3)),
+            "body_position": _view(f.body_position, (f.n_bodies, 3)),
+            "body_orientation": _view(f.body_orientation, (f.n_bodies, 4)),
+        }
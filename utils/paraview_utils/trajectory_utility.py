@@ -1,3 +1,5 @@
+from array import array
+
 import msgpack
 
 
@@ -5,6 +7,27 @@ class DesyncError(Exception):
     pass
 
 
+def expand_fibers(fibers):
+    """Convert one rank's fibers to a list of per-fiber dicts, as written before the columnar layout.
+    Only the fields stored in every columnar frame are filled in."""
+    if not isinstance(fibers, dict):
+        return fibers[0]
+
+    x = array("d", fibers["x"])
+    length = array("d", fibers["length"])
+    res = []
+    offset = 0
+    for i, n_nodes in enumerate(fibers["n_nodes"]):
+        res.append({
+            "n_nodes_": n_nodes,
+            "length_": length[i],
+            "binding_site_": fibers["binding_site"][2 * i:2 * i + 2],
+            "x_": ["__eigen__", 3, n_nodes] + x[3 * offset:3 * (offset + n_nodes)].tolist(),
+        })
+        offset += n_nodes
+    return res
+
+
 def load_frame(fhs, fpos, index):
     data = []
     for i in range(len(fhs)):
@@ -18,7 +41,7 @@ def load_frame(fhs, fpos, index):
     for el in data:
         if el["time"] != time or el["dt"] != dt:
             raise DesyncError
-        fibers.extend(el["fibers"][0])
+        fibers.extend(expand_fibers(el["fibers"]))
         el.pop("fibers")
 
     data[0]["fibers"] = fibers